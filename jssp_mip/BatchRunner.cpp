@@ -0,0 +1,154 @@
+#pragma once
+
+#include "BatchRunner.h"
+
+#include "gurobi_c++.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+
+using std::string;
+using std::vector;
+
+namespace fs = std::filesystem;
+
+
+BatchRunner::BatchRunner(ModelFactory modelFactory, int numberOfWorkers, int totalThreads, float timeLimit)
+    : modelFactory(std::move(modelFactory)), numberOfWorkers(std::max(1, numberOfWorkers)), timeLimit(timeLimit) {
+
+    if (totalThreads <= 0) {
+        totalThreads = std::max(1, (int)std::thread::hardware_concurrency());
+    }
+    threadsPerWorker = std::max(1, totalThreads / this->numberOfWorkers);
+}
+
+vector<string> BatchRunner::listInstances(const string& path, const string& extension) {
+    return listInstances(path, vector<string>{ extension });
+}
+
+vector<string> BatchRunner::listInstances(const string& path, const vector<string>& extensions) {
+    vector<string> instancePaths;
+
+    if (fs::is_directory(path)) {
+        for (const auto& entry : fs::directory_iterator(path)) {
+            if (entry.is_regular_file()
+                && std::find(extensions.begin(), extensions.end(), entry.path().extension().string()) != extensions.end()) {
+                instancePaths.push_back(entry.path().string());
+            }
+        }
+        std::sort(instancePaths.begin(), instancePaths.end());
+        return instancePaths;
+    }
+
+    std::ifstream listFile(path);
+    if (!listFile) {
+        throw std::runtime_error("Instance list not opened. Path: " + path);
+    }
+    fs::path listDirectory = fs::path(path).parent_path();
+    string line;
+    while (std::getline(listFile, line)) {
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        fs::path instancePath(line);
+        instancePaths.push_back(instancePath.is_absolute() ? line : (listDirectory / instancePath).string());
+    }
+    return instancePaths;
+}
+
+void BatchRunner::run(const vector<string>& instancePaths, const string& resultsPath) {
+    std::ofstream results(resultsPath);
+    if (!results) {
+        throw std::runtime_error("Results file not opened. Path: " + resultsPath);
+    }
+    results << "instance,status,solutions,objective,bound,gap,runtime,wall_time,error\n";
+    results.flush();
+
+    std::mutex resultsMutex;
+    std::atomic<size_t> nextInstance(0);
+
+    auto writeResult = [&](size_t idx, const SolveResult& result, string error, double wallTime) {
+        const string& instancePath = instancePaths[idx];
+        std::replace(error.begin(), error.end(), ',', ';');
+
+        std::lock_guard<std::mutex> lock(resultsMutex);
+        results << instancePath << ','
+                << (error.empty() ? result.status : 0) << ','
+                << (error.empty() ? result.solutionCount : 0) << ','
+                << result.objective << ','
+                << result.bound << ','
+                << result.gap << ','
+                << result.runtime << ','
+                << wallTime << ','
+                << error << '\n';
+        results.flush();
+        std::cout << "[" << idx + 1 << "/" << instancePaths.size() << "] " << instancePath
+                  << (error.empty() ? "" : " failed: " + error) << std::endl;
+    };
+
+    auto worker = [&](int workerID) {
+        // Environment failures (license, WLS) must not escape the thread, the instances this worker
+        // takes are recorded as failed instead.
+        std::unique_ptr<GRBEnv> env;
+        std::unique_ptr<ModelMIP> model;
+        string envError;
+        try {
+            env = std::make_unique<GRBEnv>(true);
+            env->set(GRB_IntParam_LogToConsole, 0);
+            env->set(GRB_StringParam_LogFile, "batch_worker_" + std::to_string(workerID) + ".log");
+            env->start();
+
+            model = modelFactory();
+            model->setEnv(env.get());
+            model->setThreads(threadsPerWorker);
+        }
+        catch (GRBException& e) {
+            envError = "Gurobi environment error " + std::to_string(e.getErrorCode()) + ": " + e.getMessage();
+        }
+        catch (std::exception& e) {
+            envError = e.what();
+        }
+        if (!envError.empty()) {
+            for (size_t idx = nextInstance++; idx < instancePaths.size(); idx = nextInstance++) {
+                writeResult(idx, SolveResult(), envError, 0);
+            }
+            return;
+        }
+
+        for (size_t idx = nextInstance++; idx < instancePaths.size(); idx = nextInstance++) {
+            string error;
+            auto start = std::chrono::steady_clock::now();
+            try {
+                model->solveInstance(instancePaths[idx].c_str(), timeLimit);
+            }
+            catch (GRBException& e) {
+                error = "Gurobi error " + std::to_string(e.getErrorCode()) + ": " + e.getMessage();
+            }
+            catch (std::exception& e) {
+                error = e.what();
+            }
+            double wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            writeResult(idx, model->getResult(), error, wallTime);
+        }
+    };
+
+    int workers = std::min<int>(numberOfWorkers, (int)instancePaths.size());
+    vector<std::thread> pool;
+    for (int workerID = 0; workerID < workers; workerID++) {
+        pool.emplace_back(worker, workerID);
+    }
+    for (auto& thread : pool) {
+        thread.join();
+    }
+}
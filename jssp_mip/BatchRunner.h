@@ -0,0 +1,35 @@
+#pragma once
+
+#include "ModelMIP.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+/**
+ Solves a list of instances on a fixed pool of worker threads.
+ Every worker owns one GRBEnv and one model object, Gurobi threads are split evenly between the workers.
+ One CSV line per instance is appended to the results file as soon as the instance finishes.
+ */
+class BatchRunner {
+public:
+    using ModelFactory = std::function<std::unique_ptr<ModelMIP>()>;
+
+private:
+    ModelFactory modelFactory;
+    int numberOfWorkers;
+    int threadsPerWorker;
+    float timeLimit;
+
+public:
+    // totalThreads <= 0 uses all hardware threads.
+    BatchRunner(ModelFactory modelFactory, int numberOfWorkers, int totalThreads, float timeLimit);
+
+    // Sorted files with the extension in a directory, or the lines of a list file (relative to its directory).
+    static std::vector<std::string> listInstances(const std::string& path, const std::string& extension);
+    static std::vector<std::string> listInstances(const std::string& path, const std::vector<std::string>& extensions);
+
+    void run(const std::vector<std::string>& instancePaths, const std::string& resultsPath);
+};
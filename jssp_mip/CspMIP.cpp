@@ -2,15 +2,19 @@
 
 #include "CspMIP.h"
 #include "CspReader.h"
+#include "InstanceCache.h"
 #include "CspInstance.h"
+#include "ModelBuilder.h"
 
 #include "gurobi_c++.h"
 
 #include <numeric>
 #include <string>
+#include <utility>
 #include <vector>
 
 using std::string;
+using std::vector;
 using std::cout;
 using std::endl;
 
@@ -47,29 +51,43 @@ int getSymbolIdxInAlphabet(char symbol, CspInstance& instance) {
 }
 
 void CspMIP::solveInstance(const char* instancePath, float timeLimit) {
-    //CspInstance instance = CspReader::loadInstance(instancePath);
+    result = SolveResult{ instancePath };
+    //CspInstance instance = InstanceCache::loadCsp(instancePath);
     CspInstance instance = getFakeInstance();
 
 
     // ------ Gurobi model. ---------------
-    GRBEnv* env = new GRBEnv();
-    GRBModel model = GRBModel(*env);
+    GRBModel model = GRBModel(getEnv());
+    model.set(GRB_IntParam_Threads, threads);
     model.set(GRB_StringAttr_ModelName, "Closest Substring Problem MIP solver.");
     model.set(GRB_DoubleParam_TimeLimit, timeLimit);
     model.set(GRB_IntAttr_ModelSense, GRB_MINIMIZE);
 
 
+    ModelBuilder builder(model);
+
     // ------ Variables. ---------------
+    vector<int> xIdx(instance.stringLength * instance.alphabetSize);
+    for (int i = 0; i < instance.stringLength; i++) {
+        for (int j = 0; j < instance.alphabetSize; j++) {
+            xIdx[i * instance.alphabetSize + j] = builder.queueVar(0, 1, 0, GRB_BINARY,
+                [&] { return "string_" + std::to_string(i) + "_" + instance.alphabet[j]; });
+        }
+    }
+
+    int dIdx = builder.queueVar(0, GRB_INFINITY, 1, GRB_CONTINUOUS, [] { return string("minHammingDist"); });
+
+    GRBVar* vars = builder.addQueuedVars();
+
     GRBVar** x = new GRBVar * [instance.stringLength];
     for (int i = 0; i < instance.stringLength; i++) {
         x[i] = new GRBVar[instance.alphabetSize];
         for (int j = 0; j < instance.alphabetSize; j++) {
-            string name = "string_" + std::to_string(i) + "_" + instance.alphabet[j];
-            x[i][j] = model.addVar(0, 1, 0, GRB_BINARY, name);
+            x[i][j] = vars[xIdx[i * instance.alphabetSize + j]];
         }
     }
-
-    GRBVar d = model.addVar(0, GRB_INFINITY, 1, GRB_CONTINUOUS, "minHammingDist");
+    GRBVar d = vars[dIdx];
+    delete[] vars;
 
 
     // ------ Constraints. ---------------
@@ -79,7 +97,7 @@ void CspMIP::solveInstance(const char* instancePath, float timeLimit) {
         for (int j = 0; j < instance.alphabetSize; j++) {
             expr += x[i][j];
         }
-        model.addConstr(expr == 1, "only one symbol at each index.");
+        builder.queueConstr(std::move(expr), GRB_EQUAL, 1, [] { return string("only one symbol at each index."); });
     }
 
     for (int s = 0; s < instance.numberOfStrings; s++) {
@@ -89,14 +107,18 @@ void CspMIP::solveInstance(const char* instancePath, float timeLimit) {
             int symbolIdx = getSymbolIdxInAlphabet(ch, instance);
             expr += x[i][symbolIdx];
         }
-        string name = "string " + std::to_string(s) + " has correct hamming distance.";
-        model.addConstr(instance.stringLength - expr <= d, name);
+        // stringLength - expr <= d
+        builder.queueConstr(expr + d, GRB_GREATER_EQUAL, instance.stringLength,
+                            [&] { return "string " + std::to_string(s) + " has correct hamming distance."; });
     }
 
+    builder.addQueuedConstrs();
+
 
     model.optimize();
+    recordResult(model);
 
-    if (model.get(GRB_IntAttr_Status) == GRB_OPTIMAL) {
+    if (model.get(GRB_IntAttr_SolCount) > 0) {
         cout << "\n==================================" << endl;
         cout << "minimal hamming distance: " << model.get(GRB_DoubleAttr_ObjVal) << endl;
 
@@ -127,7 +149,7 @@ void CspMIP::solveInstance(const char* instancePath, float timeLimit) {
 
         
     }
-    else {
+    else if (model.get(GRB_IntAttr_Status) == GRB_INFEASIBLE) {
         model.computeIIS();
         model.write("csp_model_IIS.ilp");
     }
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "DistanceMatrix.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// The AVX2 kernel is compiled for AVX2 on its own and only called when the CPU has it,
+// the rest of the binary keeps the baseline instruction set.
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define DISTANCE_MATRIX_AVX2
+#define AVX2_TARGET
+#include <intrin.h>
+#include <immintrin.h>
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DISTANCE_MATRIX_AVX2
+#define AVX2_TARGET __attribute__((target("avx2")))
+#include <immintrin.h>
+#endif
+
+
+namespace {
+
+int roundDistance(double distance, DistanceRounding rounding) {
+    switch (rounding) {
+    case DistanceRounding::Down: return (int)std::floor(distance);
+    case DistanceRounding::Up:   return (int)std::ceil(distance);
+    default:                     return (int)std::floor(distance + 0.5);
+    }
+}
+
+#ifdef DISTANCE_MATRIX_AVX2
+bool cpuHasAvx2() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    const bool osSavesAvx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+    __cpuidex(info, 7, 0);
+    return osSavesAvx && (info[1] & (1 << 5));
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+// Distances from point i to points j, j+1, ... in blocks of four, returns the first j left for the scalar loop.
+AVX2_TARGET int euclideanRowAvx2(const double* xs, const double* ys, int i, int j, int n, int* row, DistanceRounding rounding) {
+    const __m256d xi = _mm256_set1_pd(xs[i]);
+    const __m256d yi = _mm256_set1_pd(ys[i]);
+    const __m256d half = _mm256_set1_pd(0.5);
+    for (; j + 4 <= n; j += 4) {
+        __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(xs + j), xi);
+        __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(ys + j), yi);
+        __m256d distance = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)));
+        switch (rounding) {
+        case DistanceRounding::Down:
+            distance = _mm256_round_pd(distance, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+            break;
+        case DistanceRounding::Up:
+            distance = _mm256_round_pd(distance, _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC);
+            break;
+        default:
+            distance = _mm256_round_pd(_mm256_add_pd(distance, half), _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+            break;
+        }
+        _mm_storeu_si128((__m128i*)(row + j), _mm256_cvtpd_epi32(distance));
+    }
+    return j;
+}
+#endif
+
+}
+
+
+int DistanceMatrix::maxValue() const {
+    return values.empty() ? 0 : *std::max_element(values.begin(), values.end());
+}
+
+DistanceMatrix DistanceMatrix::euclidean(const std::vector<float>& x, const std::vector<float>& y, DistanceRounding rounding) {
+    const int n = (int)x.size();
+    DistanceMatrix matrix(n);
+
+    // Coordinates in double, so every rounding mode sees the exact square root.
+    std::vector<double> xs(x.begin(), x.end()), ys(y.begin(), y.end());
+#ifdef DISTANCE_MATRIX_AVX2
+    static const bool avx2 = cpuHasAvx2();
+#endif
+
+    for (int i = 0; i < n; ++i) {
+        int* row = matrix[i];
+        int j = i + 1;
+
+#ifdef DISTANCE_MATRIX_AVX2
+        if (avx2) {
+            j = euclideanRowAvx2(xs.data(), ys.data(), i, j, n, row, rounding);
+        }
+#endif
+        for (; j < n; ++j) {
+            double dx = xs[j] - xs[i], dy = ys[j] - ys[i];
+            row[j] = roundDistance(std::sqrt(dx * dx + dy * dy), rounding);
+        }
+    }
+
+    // Mirror the upper triangle.
+    for (int i = 1; i < n; ++i) {
+        int* row = matrix[i];
+        for (int j = 0; j < i; ++j) {
+            row[j] = matrix[j][i];
+        }
+    }
+    return matrix;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+
+enum class DistanceRounding {
+    Nearest, // halves round up, the VRP-REP / Solomon convention of this repo
+    Down,
+    Up
+};
+
+
+/**
+ Square matrix of integer distances / travel times, stored contiguously row by row.
+ matrix[i][j] reads like the nested vectors it replaces, matrix[i] is a pointer to row i.
+ */
+class DistanceMatrix {
+    int n = 0;
+    std::vector<int> values;
+
+public:
+    DistanceMatrix() = default;
+    explicit DistanceMatrix(int n) : n(n), values((size_t)n * n, 0) {}
+
+    int size() const { return n; }
+
+    const int* operator[](int i) const { return values.data() + (size_t)i * n; }
+    int* operator[](int i) { return values.data() + (size_t)i * n; }
+
+    const int* data() const { return values.data(); }
+    int* data() { return values.data(); }
+
+    int maxValue() const;
+
+    // Symmetric Euclidean distances of the points (x[i], y[i]), only the upper triangle is computed.
+    // Vectorised with AVX2 on x86 CPUs that support it (checked at run time), scalar otherwise.
+    static DistanceMatrix euclidean(const std::vector<float>& x, const std::vector<float>& y, DistanceRounding rounding);
+};
@@ -1,20 +1,25 @@
 #include "GrMIP.h"
 #include "GrInstance.h"
 #include "GrReader.h"
+#include "ModelBuilder.h"
 
 #include "gurobi_c++.h"
 
 #include <numeric>
 #include <algorithm>
 #include <string>
+#include <utility>
+#include <vector>
 
 using std::string;
+using std::vector;
 using std::cout;
 using std::endl;
 
 
 void GrMIP::solveInstance(const char* instancePath, float timeLimit) {
 // MIP model as in 74/210 Dias, Souza: http://bsb2007.inf.puc-rio.br/poster_proceedings.pdf, pg.78
+    result = SolveResult{ instancePath };
 
     GrInstance instance;
     // int n = instance.permutationLength;
@@ -24,48 +29,78 @@ void GrMIP::solveInstance(const char* instancePath, float timeLimit) {
     int n = 7;
 
     // ------ Gurobi model. ---------------
-    GRBEnv* env = new GRBEnv();
-    GRBModel model = GRBModel(*env);
+    GRBModel model = GRBModel(getEnv());
+    model.set(GRB_IntParam_Threads, threads);
     model.set(GRB_IntAttr_ModelSense, GRB_MINIMIZE);
     model.set(GRB_StringAttr_ModelName, "Genome Rearrangement problem MIP model.");
     model.set(GRB_DoubleParam_TimeLimit, timeLimit);
 
+    ModelBuilder builder(model);
+
     // ------ Variables. ---------------
 
     // B: k [0, n] | t: k [1, n] 
-    GRBVar*** B = new GRBVar ** [n]; // i = len of perm, k-th operation, has value j
+    vector<int> BIdx(n * n * n); // i = len of perm, k-th operation, has value j
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            for (int k = 0; k < n; k++) {
+                BIdx[(i * n + j) * n + k] = builder.queueVar(0, 1, 0, GRB_BINARY,
+                    [&] { return "B" + std::to_string(i) + std::to_string(j) + std::to_string(k); });
+            }
+        }
+    }
+
+    // So k_0 is identity? 
+    const int m = n + 1;
+    vector<int> TIdx(m * m * m * n, -1); // t[a,b,c,k]   a,b,c indexed from 0 not from 1 as in paper
+    for (int a = 0; a < n + 1; a++) {
+        for (int b = a + 1; b < n + 1; b++) {
+            for (int c = b + 1; c < n + 1; c++) {
+                for (int k = 0; k < n; k++) { // k indexed from 0
+                    TIdx[((a * m + b) * m + c) * n + k] = builder.queueVar(0, 1, 0, GRB_BINARY,
+                        [&] { return "T" + std::to_string(a) + std::to_string(b) + std::to_string(c) + std::to_string(k); });
+                }
+            }
+        }
+    }
+
+    vector<int> tIdx(n); // 't[k]' tells whether kth transposition operation has modified the permutation.
+    for (int k = 0; k < n; k++) {
+        tIdx[k] = builder.queueVar(0, 1, 1, GRB_BINARY, [&] { return "t" + std::to_string(k); });
+    }
+
+    GRBVar* vars = builder.addQueuedVars();
+
+    GRBVar*** B = new GRBVar ** [n];
     for (int i = 0; i < n; i++) {
         B[i] = new  GRBVar * [n];
         for (int j = 0; j < n; j++) {
             B[i][j] = new  GRBVar[n];
             for (int k = 0; k < n; k++) {
-                string name = "B" + std::to_string(i) + std::to_string(j) + std::to_string(k);
-                B[i][j][k] = model.addVar(0, 1, 0, GRB_BINARY, name);
+                B[i][j][k] = vars[BIdx[(i * n + j) * n + k]];
             }
         }
     }
 
-    // So k_0 is identity? 
-    GRBVar**** T = new GRBVar * * *[n + 1]; // t[a,b,c,k]   a,b,c indexed from 0 not from 1 as in paper
+    GRBVar**** T = new GRBVar * * *[n + 1];
     for (int a = 0; a < n + 1; a++) {
         T[a] = new  GRBVar * *[n + 1];
         for (int b = a + 1; b < n + 1; b++) {
             T[a][b] = new  GRBVar * [n + 1];
             for (int c = b + 1; c < n + 1; c++) {
                 T[a][b][c] = new  GRBVar[n];
-                for (int k = 0; k < n; k++) { // k indexed from 0
-                    string name = "T" + std::to_string(a) + std::to_string(b) + std::to_string(c) + std::to_string(k);
-                    T[a][b][c][k] = model.addVar(0, 1, 0, GRB_BINARY, name);
+                for (int k = 0; k < n; k++) {
+                    T[a][b][c][k] = vars[TIdx[((a * m + b) * m + c) * n + k]];
                 }
             }
         }
     }
 
-    GRBVar* t = new GRBVar[n]; // 't[k]' tells whether kth transposition operation has modified the permutation.
+    GRBVar* t = new GRBVar[n];
     for (int k = 0; k < n; k++) {
-        string name = "t" + std::to_string(k);
-        t[k] = model.addVar(0, 1, 1, GRB_BINARY, name);
+        t[k] = vars[tIdx[k]];
     }
+    delete[] vars;
 
 
     // ------ Constraints. ---------------
@@ -74,12 +109,12 @@ void GrMIP::solveInstance(const char* instancePath, float timeLimit) {
 
     // (1)
     for (int i = 0; i < n; i++) {
-        model.addConstr(B[i][perm1[i]][0] == 1);
+        builder.queueConstr(GRBLinExpr(B[i][perm1[i]][0]), GRB_EQUAL, 1);
     }
 
     // (2)
     for (int i = 0; i < n; i++) {
-        model.addConstr(B[i][perm2[i]][n - 1] == 1);
+        builder.queueConstr(GRBLinExpr(B[i][perm2[i]][n - 1]), GRB_EQUAL, 1);
     }
 
     // (3)
@@ -89,7 +124,7 @@ void GrMIP::solveInstance(const char* instancePath, float timeLimit) {
             for (int j = 0; j < n; j++) {
                 expr += B[i][j][k];
             }
-            model.addConstr(expr == 1);
+            builder.queueConstr(std::move(expr), GRB_EQUAL, 1);
         }   
     }
 
@@ -100,13 +135,13 @@ void GrMIP::solveInstance(const char* instancePath, float timeLimit) {
             for (int i = 0; i < n; i++) {
                 expr += B[i][j][k];
             }
-            model.addConstr(expr == 1);
+            builder.queueConstr(std::move(expr), GRB_EQUAL, 1);
         }
     }
 
     // (5)
     for (int k = 1; k < n; k++) {
-        model.addConstr(t[k] <= t[k - 1]);
+        builder.queueConstr(t[k] - t[k - 1], GRB_LESS_EQUAL, 0);
     }
 
     // (6)
@@ -119,7 +154,7 @@ void GrMIP::solveInstance(const char* instancePath, float timeLimit) {
                 }
             }
         }
-        model.addConstr(expr <= t[k]);
+        builder.queueConstr(expr - t[k], GRB_LESS_EQUAL, 0);
     }
 
     // (7)
@@ -142,7 +177,8 @@ void GrMIP::solveInstance(const char* instancePath, float timeLimit) {
                         }
                     }
                 }
-                model.addConstr(expr + expr2 + (1 - t[k]) + B[i][j][k - 1] - B[i][j][k] <= 1);
+                // expr + expr2 + (1 - t[k]) + B[i][j][k - 1] - B[i][j][k] <= 1
+                builder.queueConstr(expr + expr2 - t[k] + B[i][j][k - 1] - B[i][j][k], GRB_LESS_EQUAL, 0);
             }
         }
     }
@@ -154,7 +190,7 @@ void GrMIP::solveInstance(const char* instancePath, float timeLimit) {
                 for (int b = a + 1; b < n + 1; b++) {
                     for (int c = b + 1; c < n + 1; c++) {
                         for (int i = a; i < a + c - b; i++) {
-                            model.addConstr(T[a][b][c][k] + B[b - a + i][j][k - 1] - B[i][j][k] <= 1);
+                            builder.queueConstr(T[a][b][c][k] + B[b - a + i][j][k - 1] - B[i][j][k], GRB_LESS_EQUAL, 1);
                         }
                     }
                 }
@@ -169,7 +205,7 @@ void GrMIP::solveInstance(const char* instancePath, float timeLimit) {
                 for (int b = a + 1; b < n + 1; b++) {
                     for (int c = b + 1; c < n + 1; c++) {
                         for (int i = a + c - b; i < c; i++) {
-                            model.addConstr(T[a][b][c][k] + B[b - c + i][j][k - 1] - B[i][j][k] <= 1);
+                            builder.queueConstr(T[a][b][c][k] + B[b - c + i][j][k - 1] - B[i][j][k], GRB_LESS_EQUAL, 1);
                         }
                     }
                 }
@@ -177,12 +213,15 @@ void GrMIP::solveInstance(const char* instancePath, float timeLimit) {
         }
     }
 
+    builder.addQueuedConstrs();
+
 
     //------- Solve the model. -----------
     model.optimize();
+    recordResult(model);
 
 
-    if (model.get(GRB_IntAttr_Status) == GRB_OPTIMAL) {
+    if (model.get(GRB_IntAttr_SolCount) > 0) {
         cout << "\n==================================" << endl;
         cout << "minimal number of transpositions: " << model.get(GRB_DoubleAttr_ObjVal) << endl;
         for (int k = 0; k < n; k++) {
@@ -202,7 +241,7 @@ void GrMIP::solveInstance(const char* instancePath, float timeLimit) {
         cout << endl;
         cout << "==================================\n";
     }
-    else {
+    else if (model.get(GRB_IntAttr_Status) == GRB_INFEASIBLE) {
         model.computeIIS();
         model.write("gr_model_IIS.ilp");
     }
@@ -0,0 +1,383 @@
+#pragma once
+
+#include "InstanceCache.h"
+#include "LoaderJSPLIB.h"
+#include "CspReader.h"
+#include "SolomonReader.h"
+#include "MappedFile.h"
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+using std::string;
+using std::string_view;
+using std::vector;
+
+namespace fs = std::filesystem;
+
+
+namespace {
+
+constexpr char cacheMagic[8] = { 'J', 'M', 'I', 'P', 'I', 'N', 'S', 'T' };
+constexpr uint32_t cacheVersion = 2;
+const string cacheExtension = ".bin";
+
+enum class InstanceKind : uint32_t {
+    Jsp = 1,
+    Vrptw = 2,
+    Csp = 3
+};
+
+struct CacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t kind;
+    uint64_t sourceSize;
+    int64_t sourceTime;   // last write time of the source, in file clock ticks
+    uint64_t payloadSize;
+    uint64_t payloadHash; // FNV-1a 64 of the payload
+};
+
+uint64_t fnv1a(string_view bytes) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char byte : bytes) {
+        hash ^= byte;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+bool endsWith(const string& text, const string& suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Source file of an instance spec, "path#name" -> "path".
+string sourceFile(const string& instanceSpec) {
+    size_t separator = instanceSpec.rfind('#');
+    return separator == string::npos ? instanceSpec : instanceSpec.substr(0, separator);
+}
+
+// VRP-REP XML, or Solomon / Gehring-Homberger text for any other extension.
+VrptwInstance parseVrptw(const string& path) {
+    return endsWith(path, ".xml") ? getInstance(path.c_str()) : SolomonReader::loadInstance(path);
+}
+
+void fingerprint(const string& sourcePath, uint64_t& size, int64_t& time) {
+    std::error_code error;
+    size = (uint64_t)fs::file_size(sourcePath, error);
+    if (error) {size = 0;}
+    time = (int64_t)fs::last_write_time(sourcePath, error).time_since_epoch().count();
+    if (error) {time = 0;}
+}
+
+
+class CacheWriter {
+    string payload;
+
+public:
+    void putInt(int value) {
+        int32_t stored = value;
+        payload.append((const char*)&stored, sizeof(stored));
+    }
+
+    void putInts(const int* values, size_t count) {
+        for (size_t k = 0; k < count; ++k) {
+            putInt(values[k]);
+        }
+    }
+
+    void putString(string_view text) {
+        putInt((int)text.size());
+        payload.append(text.data(), text.size());
+    }
+
+    // Header and payload go to a temporary file renamed over cachePath, readers never see a partial file.
+    void save(const string& cachePath, InstanceKind kind, const string& sourcePath) const {
+        CacheHeader header = {};
+        std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+        header.version = cacheVersion;
+        header.kind = (uint32_t)kind;
+        fingerprint(sourcePath, header.sourceSize, header.sourceTime);
+        header.payloadSize = payload.size();
+        header.payloadHash = fnv1a(payload);
+
+        const string temporaryPath = cachePath + ".tmp";
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            if (!file) {
+                throw std::runtime_error("Cache file not opened. File path: " + temporaryPath);
+            }
+            file.write((const char*)&header, sizeof(header));
+            file.write(payload.data(), payload.size());
+            if (!file) {
+                throw std::runtime_error("Cache file not written. File path: " + temporaryPath);
+            }
+        }
+        fs::rename(temporaryPath, cachePath);
+    }
+};
+
+
+class CacheReader {
+    MappedFile file;
+    string_view payload;
+    size_t pos = 0;
+    string path;
+
+    std::runtime_error corrupted() const {
+        return std::runtime_error("Corrupted instance cache. File path: " + path);
+    }
+
+public:
+    // Maps the cache and checks magic, version, kind and payload hash. sourcePath, if not empty, must match the fingerprint.
+    CacheReader(const string& cachePath, InstanceKind kind, const string& sourcePath) : file(cachePath), path(cachePath) {
+        CacheHeader header;
+        if (file.size() < sizeof(header)) {
+            throw corrupted();
+        }
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0 || header.version != cacheVersion
+            || header.kind != (uint32_t)kind || header.payloadSize != file.size() - sizeof(header)) {
+            throw corrupted();
+        }
+        if (!sourcePath.empty()) {
+            uint64_t size;
+            int64_t time;
+            fingerprint(sourcePath, size, time);
+            if (size != header.sourceSize || time != header.sourceTime) {
+                throw std::runtime_error("Instance cache is older than its source. File path: " + path);
+            }
+        }
+        payload = file.view().substr(sizeof(header));
+        if (fnv1a(payload) != header.payloadHash) {
+            throw corrupted();
+        }
+    }
+
+    int getInt() {
+        int32_t value;
+        if (pos + sizeof(value) > payload.size()) {
+            throw corrupted();
+        }
+        std::memcpy(&value, payload.data() + pos, sizeof(value));
+        pos += sizeof(value);
+        return value;
+    }
+
+    // Non-negative count of elements of the given size that fit in the rest of the payload.
+    int getCount(size_t elementSize) {
+        int count = getInt();
+        if (count < 0 || (size_t)count * elementSize > payload.size() - pos) {
+            throw corrupted();
+        }
+        return count;
+    }
+
+    // Checked before allocating arrays, so a corrupted count cannot allocate much.
+    void require(size_t bytes) const {
+        if (bytes > payload.size() - pos) {
+            throw corrupted();
+        }
+    }
+
+    void getInts(int* values, size_t count) {
+        if (count * sizeof(int32_t) > payload.size() - pos) {
+            throw corrupted();
+        }
+        std::memcpy(values, payload.data() + pos, count * sizeof(int32_t));
+        pos += count * sizeof(int32_t);
+    }
+
+    string getString() {
+        int length = getCount(1);
+        string text(payload.substr(pos, length));
+        pos += length;
+        return text;
+    }
+
+    void finish() const {
+        if (pos != payload.size()) {
+            throw corrupted();
+        }
+    }
+};
+
+// Reads the spec if it is a cache file, else its cache if there is a valid one, else parses the source.
+// A stale or corrupted cache next to the source is reported and skipped.
+template <typename Instance, typename Read, typename Parse>
+Instance loadInstance(const string& instanceSpec, InstanceKind kind, Read read, Parse parse) {
+    if (endsWith(instanceSpec, cacheExtension)) {
+        CacheReader reader(instanceSpec, kind, "");
+        return read(reader);
+    }
+    const string cache = InstanceCache::cachePath(instanceSpec);
+    if (fs::exists(cache)) {
+        try {
+            CacheReader reader(cache, kind, sourceFile(instanceSpec));
+            return read(reader);
+        }
+        catch (const std::runtime_error& error) {
+            std::cerr << error.what() << ", parsing the source instead." << std::endl;
+        }
+    }
+    return parse();
+}
+
+}
+
+
+string InstanceCache::cachePath(const string& instanceSpec) {
+    size_t separator = instanceSpec.rfind('#');
+    if (separator == string::npos) {
+        return instanceSpec + cacheExtension;
+    }
+    return instanceSpec.substr(0, separator) + "." + instanceSpec.substr(separator + 1) + cacheExtension;
+}
+
+// ------ Writers. ---------------
+
+void InstanceCache::write(const JSPLIBInstance& instance, const string& cachePath, const string& sourcePath) {
+    CacheWriter writer;
+    writer.putString(instance.instanceName);
+    writer.putInt(instance.numberOfJobs);
+    writer.putInt(instance.numberOfMachines);
+    for (const vector<int>& row : instance.precedencesMatrix) {
+        writer.putInts(row.data(), instance.numberOfMachines);
+    }
+    for (const vector<int>& row : instance.durationsMatrix) {
+        writer.putInts(row.data(), instance.numberOfMachines);
+    }
+    writer.save(cachePath, InstanceKind::Jsp, sourcePath);
+}
+
+void InstanceCache::write(const VrptwInstance& instance, const string& cachePath, const string& sourcePath) {
+    const int N = instance.numberOfNodes;
+    CacheWriter writer;
+    writer.putInt(N);
+    writer.putInt(instance.vehicleCapacity);
+    writer.putInt(instance.fleetSize);
+    writer.putInts(instance.distanceMatrix.data(), (size_t)N * N);
+    writer.putInts(instance.demands.data(), N);
+    for (const auto& timeWindow : instance.timeWindows) {
+        writer.putInt(timeWindow.first);
+        writer.putInt(timeWindow.second);
+    }
+    writer.putInts(instance.serviceTimes.data(), N);
+    writer.save(cachePath, InstanceKind::Vrptw, sourcePath);
+}
+
+void InstanceCache::write(const CspInstance& instance, const string& cachePath, const string& sourcePath) {
+    CacheWriter writer;
+    writer.putString(string_view(instance.alphabet, instance.alphabet ? instance.alphabetSize : 0));
+    writer.putInt(instance.stringLength);
+    writer.putInt(instance.numberOfStrings);
+    for (int k = 0; k < instance.numberOfStrings; ++k) {
+        writer.putString(instance.strings[k]);
+    }
+    writer.save(cachePath, InstanceKind::Csp, sourcePath);
+}
+
+// ------ Loaders. ---------------
+
+JSPLIBInstance InstanceCache::loadJsp(const string& instanceSpec) {
+    auto read = [](CacheReader& reader) {
+        JSPLIBInstance instance;
+        instance.instanceName = reader.getString();
+        instance.numberOfJobs = reader.getCount(sizeof(int32_t));
+        instance.numberOfMachines = reader.getCount(sizeof(int32_t));
+        reader.require(2 * sizeof(int32_t) * instance.numberOfJobs * instance.numberOfMachines);
+
+        instance.precedencesMatrix.assign(instance.numberOfJobs, vector<int>(instance.numberOfMachines));
+        instance.durationsMatrix.assign(instance.numberOfJobs, vector<int>(instance.numberOfMachines));
+        for (vector<int>& row : instance.precedencesMatrix) {
+            reader.getInts(row.data(), row.size());
+        }
+        for (vector<int>& row : instance.durationsMatrix) {
+            reader.getInts(row.data(), row.size());
+        }
+        reader.finish();
+        return instance;
+    };
+    return loadInstance<JSPLIBInstance>(instanceSpec, InstanceKind::Jsp, read,
+                                        [&]() { return LoaderJSPLIB::loadInstanceSpec(instanceSpec); });
+}
+
+VrptwInstance InstanceCache::loadVrptw(const string& instancePath) {
+    auto read = [](CacheReader& reader) {
+        VrptwInstance instance;
+        const int N = instance.numberOfNodes = reader.getCount(sizeof(int32_t));
+        instance.vehicleCapacity = reader.getInt();
+        instance.fleetSize = reader.getInt();
+        reader.require(sizeof(int32_t) * ((size_t)N * N + 4 * N));
+
+        instance.distanceMatrix = DistanceMatrix(N);
+        reader.getInts(instance.distanceMatrix.data(), (size_t)N * N);
+        instance.demands.resize(N);
+        reader.getInts(instance.demands.data(), N);
+        instance.timeWindows.resize(N);
+        for (auto& timeWindow : instance.timeWindows) {
+            timeWindow.first = reader.getInt();
+            timeWindow.second = reader.getInt();
+        }
+        instance.serviceTimes.resize(N);
+        reader.getInts(instance.serviceTimes.data(), N);
+        reader.finish();
+        return instance;
+    };
+    return loadInstance<VrptwInstance>(instancePath, InstanceKind::Vrptw, read,
+                                       [&]() { return parseVrptw(instancePath); });
+}
+
+CspInstance InstanceCache::loadCsp(const string& instancePath) {
+    auto read = [](CacheReader& reader) {
+        string alphabet = reader.getString();
+        int stringLength = reader.getInt();
+        vector<string> strings(reader.getCount(sizeof(int32_t)));
+        for (string& text : strings) {
+            text = reader.getString();
+        }
+        reader.finish();
+
+        CspInstance instance;
+        instance.alphabetSize = (int)alphabet.size();
+        instance.alphabet = new char[alphabet.size()];
+        std::memcpy(instance.alphabet, alphabet.data(), alphabet.size());
+        instance.stringLength = stringLength;
+        instance.numberOfStrings = (int)strings.size();
+        instance.strings = new string[strings.size()];
+        std::move(strings.begin(), strings.end(), instance.strings);
+        return instance;
+    };
+    return loadInstance<CspInstance>(instancePath, InstanceKind::Csp, read,
+                                     [&]() { return CspReader::loadInstance(instancePath.c_str()); });
+}
+
+string InstanceCache::convert(const string& problem, const string& instanceSpec) {
+    const string cache = cachePath(instanceSpec);
+    const string source = sourceFile(instanceSpec);
+
+    if (problem == "jsp") {
+        write(LoaderJSPLIB::loadInstanceSpec(instanceSpec), cache, source);
+    }
+    else if (problem == "vrptw") {
+        write(parseVrptw(instanceSpec), cache, source);
+    }
+    else if (problem == "csp") {
+        CspInstance instance = CspReader::loadInstance(instanceSpec.c_str());
+        write(instance, cache, source);
+        delete[] instance.alphabet;
+        delete[] instance.strings;
+    }
+    else {
+        throw std::runtime_error("No instance cache for problem type " + problem);
+    }
+    return cache;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "JspInstance.h"
+#include "VrptwInstance.h"
+#include "CspInstance.h"
+
+#include <string>
+
+
+/**
+ Versioned binary cache of parsed instances, so batch runs skip text / XML parsing and distance matrix construction.
+ A cache file is a fixed header (magic, format version, problem kind, size and modification time of the source file,
+ payload size and FNV-1a hash of the payload) followed by flat little-endian int32 arrays; strings are length-prefixed.
+ Files are memory mapped on load and rejected if the header, the hash or the source fingerprint do not match.
+ */
+class InstanceCache {
+public:
+    // Cache file of an instance: "<path>.bin", "<path>.<name>.bin" for a "path#name" JSPLIB spec.
+    static std::string cachePath(const std::string& instanceSpec);
+
+    // Write the cache file of the instance, sourcePath is fingerprinted to detect later edits.
+    static void write(const JSPLIBInstance& instance, const std::string& cachePath, const std::string& sourcePath);
+    static void write(const VrptwInstance& instance, const std::string& cachePath, const std::string& sourcePath);
+    static void write(const CspInstance& instance, const std::string& cachePath, const std::string& sourcePath);
+
+    // Load a ".bin" file directly, otherwise the up-to-date cache of the instance if there is one, else parse the source.
+    static JSPLIBInstance loadJsp(const std::string& instanceSpec);
+    static VrptwInstance loadVrptw(const std::string& instancePath);
+    static CspInstance loadCsp(const std::string& instancePath);
+
+    // Parse the instance and write its cache file, returns the cache path.
+    static std::string convert(const std::string& problem, const std::string& instanceSpec);
+};
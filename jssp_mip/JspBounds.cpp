@@ -0,0 +1,129 @@
+#pragma once
+
+#include "JspBounds.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <utility>
+#include <vector>
+
+
+using std::vector;
+
+
+vector<vector<int>> JspBounds::computeHeads(const JSPLIBInstance& instance) {
+    vector<vector<int>> heads(instance.numberOfJobs, vector<int>(instance.numberOfMachines, 0));
+
+    for (int jobID = 0; jobID < instance.numberOfJobs; jobID++) {
+        int head = 0;
+        for (int i = 0; i < instance.numberOfMachines; i++) {
+            int machineID = instance.precedencesMatrix[jobID][i];
+            heads[jobID][machineID] = head;
+            head += instance.durationsMatrix[jobID][machineID];
+        }
+    }
+    return heads;
+}
+
+vector<vector<int>> JspBounds::computeTails(const JSPLIBInstance& instance) {
+    vector<vector<int>> tails(instance.numberOfJobs, vector<int>(instance.numberOfMachines, 0));
+
+    for (int jobID = 0; jobID < instance.numberOfJobs; jobID++) {
+        int tail = 0;
+        for (int i = instance.numberOfMachines - 1; i >= 0; i--) {
+            int machineID = instance.precedencesMatrix[jobID][i];
+            tails[jobID][machineID] = tail;
+            tail += instance.durationsMatrix[jobID][machineID];
+        }
+    }
+    return tails;
+}
+
+int JspBounds::disjunctiveBigM(const vector<vector<int>>& heads,
+                               const vector<vector<int>>& tails,
+                               int upperBound, int machineID, int jobBefore, int jobAfter) {
+    // x[jobBefore] + p[jobBefore] <= upperBound - tail[jobBefore] and x[jobAfter] >= head[jobAfter],
+    // so the row is redundant for M = upperBound - tail[jobBefore] - head[jobAfter].
+    int bigM = upperBound - tails[jobBefore][machineID] - heads[jobAfter][machineID];
+    return std::max(0, bigM);
+}
+
+int JspBounds::jobLoadBound(const JSPLIBInstance& instance) {
+    int bound = 0;
+    for (int jobID = 0; jobID < instance.numberOfJobs; jobID++) {
+        int sum = std::accumulate(std::begin(instance.durationsMatrix[jobID]), std::end(instance.durationsMatrix[jobID]), 0);
+        bound = std::max(bound, sum);
+    }
+    return bound;
+}
+
+int JspBounds::machineLoadBound(const JSPLIBInstance& instance,
+                                const vector<vector<int>>& heads,
+                                const vector<vector<int>>& tails) {
+    int bound = 0;
+    for (int machineID = 0; machineID < instance.numberOfMachines; machineID++) {
+        int minHead = std::numeric_limits<int>::max();
+        int minTail = std::numeric_limits<int>::max();
+        int load = 0;
+        for (int jobID = 0; jobID < instance.numberOfJobs; jobID++) {
+            minHead = std::min(minHead, heads[jobID][machineID]);
+            minTail = std::min(minTail, tails[jobID][machineID]);
+            load += instance.durationsMatrix[jobID][machineID];
+        }
+        bound = std::max(bound, minHead + load + minTail);
+    }
+    return bound;
+}
+
+int JspBounds::preemptiveOneMachineBound(const JSPLIBInstance& instance,
+                                         const vector<vector<int>>& heads,
+                                         const vector<vector<int>>& tails) {
+    int bound = 0;
+    vector<int> jobsByHead(instance.numberOfJobs);
+    vector<int> remaining(instance.numberOfJobs);
+
+    for (int machineID = 0; machineID < instance.numberOfMachines; machineID++) {
+        std::iota(jobsByHead.begin(), jobsByHead.end(), 0);
+        std::sort(jobsByHead.begin(), jobsByHead.end(), [&](int a, int b) {
+            return heads[a][machineID] < heads[b][machineID];
+        });
+        for (int jobID = 0; jobID < instance.numberOfJobs; jobID++) {
+            remaining[jobID] = instance.durationsMatrix[jobID][machineID];
+        }
+
+        // Jackson's preemptive schedule: always run the released job with the largest tail.
+        std::priority_queue<std::pair<int, int>> released; // (tail, jobID)
+        int time = 0;
+        int next = 0;
+        while (next < instance.numberOfJobs || !released.empty()) {
+            if (released.empty()) {
+                time = std::max(time, heads[jobsByHead[next]][machineID]);
+            }
+            while (next < instance.numberOfJobs && heads[jobsByHead[next]][machineID] <= time) {
+                int jobID = jobsByHead[next++];
+                released.emplace(tails[jobID][machineID], jobID);
+            }
+
+            int jobID = released.top().second;
+            int nextRelease = next < instance.numberOfJobs ? heads[jobsByHead[next]][machineID] : std::numeric_limits<int>::max();
+            int runTime = std::min(remaining[jobID], nextRelease - time);
+            time += runTime;
+            remaining[jobID] -= runTime;
+            if (remaining[jobID] == 0) {
+                released.pop();
+                bound = std::max(bound, time + tails[jobID][machineID]);
+            }
+        }
+    }
+    return bound;
+}
+
+int JspBounds::lowerBound(const JSPLIBInstance& instance,
+                          const vector<vector<int>>& heads,
+                          const vector<vector<int>>& tails) {
+    return std::max({ jobLoadBound(instance),
+                      machineLoadBound(instance, heads, tails),
+                      preemptiveOneMachineBound(instance, heads, tails) });
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "JspInstance.h"
+
+#include <vector>
+
+
+/**
+ Bounds on operation start times and on the makespan derived from the job routes.
+ head = earliest start given the job predecessors, tail = work left in the job after the operation.
+ */
+class JspBounds {
+
+public:
+    static std::vector<std::vector<int>> computeHeads(const JSPLIBInstance& instance);
+
+    static std::vector<std::vector<int>> computeTails(const JSPLIBInstance& instance);
+
+    // Big-M of the row "x[after] >= x[before] + p[before] - M", valid for every schedule with Cmax <= upperBound.
+    static int disjunctiveBigM(const std::vector<std::vector<int>>& heads,
+                               const std::vector<std::vector<int>>& tails,
+                               int upperBound, int machineID, int jobBefore, int jobAfter);
+
+    // Longest job.
+    static int jobLoadBound(const JSPLIBInstance& instance);
+
+    // max over machines of min head + machine load + min tail.
+    static int machineLoadBound(const JSPLIBInstance& instance,
+                                const std::vector<std::vector<int>>& heads,
+                                const std::vector<std::vector<int>>& tails);
+
+    // max over machines of the optimal preemptive one-machine schedule with heads and tails (Jackson's rule).
+    static int preemptiveOneMachineBound(const JSPLIBInstance& instance,
+                                         const std::vector<std::vector<int>>& heads,
+                                         const std::vector<std::vector<int>>& tails);
+
+    // Strongest of the bounds above.
+    static int lowerBound(const JSPLIBInstance& instance,
+                          const std::vector<std::vector<int>>& heads,
+                          const std::vector<std::vector<int>>& tails);
+};
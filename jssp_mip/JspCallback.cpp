@@ -0,0 +1,122 @@
+#pragma once
+
+#include "JspCallback.h"
+#include "JspBounds.h"
+
+#include <algorithm>
+#include <mutex>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+
+using std::vector;
+
+
+JspCallback::JspCallback(const JSPLIBInstance& instance, GRBVar Cmax, GRBVar** x, GRBVar*** z, bool pairwiseDisjunctions)
+    : instance(instance), Cmax(Cmax), x(x), z(z), pairwiseDisjunctions(pairwiseDisjunctions) {
+}
+
+void JspCallback::offerSchedule(const JspSchedule& schedule) {
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    if (!hasPendingSchedule || schedule.makespan < pendingSchedule.makespan) {
+        pendingSchedule = schedule;
+        hasPendingSchedule = true;
+    }
+}
+
+void JspCallback::enableLazyDisjunctions(const vector<vector<int>>& heads,
+                                         const vector<vector<int>>& tails, int upperBound) {
+    lazyDisjunctions = true;
+    this->heads = &heads;
+    this->tails = &tails;
+    this->upperBound = upperBound;
+}
+
+void JspCallback::addLazyDisjunction(int machineID, int j, int k) {
+    // Same rows as the full model adds up front, j < k.
+    int pj = instance.durationsMatrix[j][machineID];
+    int pk = instance.durationsMatrix[k][machineID];
+    int bigMkj = JspBounds::disjunctiveBigM(*heads, *tails, upperBound, machineID, k, j);
+    int bigMjk = JspBounds::disjunctiveBigM(*heads, *tails, upperBound, machineID, j, k);
+
+    addLazy(x[j][machineID] >= x[k][machineID] + pk - bigMkj * z[machineID][j][k]);
+    addLazy(x[k][machineID] >= x[j][machineID] + pj - bigMjk * (1 - z[machineID][j][k]));
+    if (!pairwiseDisjunctions) {
+        addLazy(x[k][machineID] >= x[j][machineID] + pj - bigMjk * z[machineID][k][j]);
+        addLazy(x[j][machineID] >= x[k][machineID] + pk - bigMkj * (1 - z[machineID][k][j]));
+    }
+}
+
+void JspCallback::addViolatedDisjunctions() {
+    vector<double> start(instance.numberOfJobs);
+    vector<int> jobsByStart(instance.numberOfJobs);
+
+    for (int machineID = 0; machineID < instance.numberOfMachines; machineID++) {
+        for (int jobID = 0; jobID < instance.numberOfJobs; jobID++) {
+            start[jobID] = getSolution(x[jobID][machineID]);
+        }
+        std::iota(jobsByStart.begin(), jobsByStart.end(), 0);
+        std::sort(jobsByStart.begin(), jobsByStart.end(), [&](int a, int b) { return start[a] < start[b]; });
+
+        // Every job overlapping with a job that started before it. Added again for every candidate that violates it,
+        // Gurobi only rejects the candidate if a lazy constraint is added in this callback.
+        for (int a = 0; a < instance.numberOfJobs; a++) {
+            int first = jobsByStart[a];
+            double end = start[first] + instance.durationsMatrix[first][machineID];
+            for (int b = a + 1; b < instance.numberOfJobs && start[jobsByStart[b]] < end - 0.5; b++) {
+                int j = std::min(first, jobsByStart[b]);
+                int k = std::max(first, jobsByStart[b]);
+                addLazyDisjunction(machineID, j, k);
+            }
+        }
+    }
+}
+
+void JspCallback::setSchedule(const JspSchedule& schedule) {
+    const std::vector<std::vector<int>>& start = schedule.startTimes;
+
+    setSolution(Cmax, schedule.makespan);
+    for (int i = 0; i < instance.numberOfJobs; i++) {
+        for (int j = 0; j < instance.numberOfMachines; j++) {
+            setSolution(x[i][j], start[i][j]);
+        }
+    }
+    for (int i = 0; i < instance.numberOfMachines; i++) {
+        for (int j = 0; j < instance.numberOfJobs; j++) {
+            int kStart = pairwiseDisjunctions ? j + 1 : 0;
+            for (int k = kStart; k < instance.numberOfJobs; k++) {
+                if (j == k) {
+                    continue;
+                }
+                setSolution(z[i][j][k], start[j][i] < start[k][i] ? 1 : 0);
+            }
+        }
+    }
+}
+
+void JspCallback::callback() {
+    try {
+        if (where == GRB_CB_MIPSOL && lazyDisjunctions) {
+            addViolatedDisjunctions();
+        }
+        else if (where == GRB_CB_MIPNODE) {
+            JspSchedule schedule;
+            {
+                std::lock_guard<std::mutex> lock(pendingMutex);
+                if (!hasPendingSchedule) {
+                    return;
+                }
+                schedule = std::move(pendingSchedule);
+                hasPendingSchedule = false;
+            }
+            if (schedule.makespan < getDoubleInfo(GRB_CB_MIPNODE_OBJBST)) {
+                setSchedule(schedule);
+                useSolution();
+            }
+        }
+    }
+    catch (GRBException& e) {
+        std::cout << "JSP callback error " << e.getErrorCode() << ": " << e.getMessage() << std::endl;
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "JspInstance.h"
+
+#include "gurobi_c++.h"
+
+#include <mutex>
+#include <vector>
+
+
+/**
+ Gurobi callback of the disjunctive JSP model.
+ Schedules offered from other threads (tabu search) are injected into the MIP as heuristic solutions.
+ With lazy disjunctions, machine overlaps of new incumbents are cut off by the violated big-M rows.
+ */
+class JspCallback : public GRBCallback {
+    const JSPLIBInstance& instance;
+    GRBVar Cmax;
+    GRBVar** x;
+    GRBVar*** z;
+    bool pairwiseDisjunctions;
+
+    std::mutex pendingMutex;
+    JspSchedule pendingSchedule;
+    bool hasPendingSchedule = false;
+
+    bool lazyDisjunctions = false;
+    const std::vector<std::vector<int>>* heads = nullptr;
+    const std::vector<std::vector<int>>* tails = nullptr;
+    int upperBound = 0;
+
+    void setSchedule(const JspSchedule& schedule);
+    void addViolatedDisjunctions();
+    void addLazyDisjunction(int machineID, int j, int k);
+
+protected:
+    void callback();
+
+public:
+    JspCallback(const JSPLIBInstance& instance, GRBVar Cmax, GRBVar** x, GRBVar*** z, bool pairwiseDisjunctions);
+
+    // Thread safe, the schedule is passed to Gurobi at the next MIP node.
+    void offerSchedule(const JspSchedule& schedule);
+
+    // Separates the disjunctive rows in MIPSOL, the model must have LazyConstraints set.
+    void enableLazyDisjunctions(const std::vector<std::vector<int>>& heads,
+                                const std::vector<std::vector<int>>& tails, int upperBound);
+};
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "JspHeuristics.h"
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+
+
+using std::vector;
+
+
+JspSchedule JspHeuristics::earliestStartSchedule(const JSPLIBInstance& instance) {
+    vector<vector<int>> startTimes(instance.numberOfJobs, vector<int>(instance.numberOfMachines, 0));
+    vector<int> nextOperation(instance.numberOfJobs, 0); // position in the job route
+    vector<int> jobReady(instance.numberOfJobs, 0);
+    vector<int> machineReady(instance.numberOfMachines, 0);
+
+    int makespan = 0;
+    for (int scheduled = 0; scheduled < instance.numberOfJobs * instance.numberOfMachines; scheduled++) {
+        int bestJob = -1;
+        int bestStart = std::numeric_limits<int>::max();
+        for (int jobID = 0; jobID < instance.numberOfJobs; jobID++) {
+            if (nextOperation[jobID] == instance.numberOfMachines) {
+                continue;
+            }
+            int machineID = instance.precedencesMatrix[jobID][nextOperation[jobID]];
+            int start = std::max(jobReady[jobID], machineReady[machineID]);
+            if (start < bestStart) {
+                bestStart = start;
+                bestJob = jobID;
+            }
+        }
+
+        int machineID = instance.precedencesMatrix[bestJob][nextOperation[bestJob]];
+        int end = bestStart + instance.durationsMatrix[bestJob][machineID];
+        startTimes[bestJob][machineID] = bestStart;
+        jobReady[bestJob] = end;
+        machineReady[machineID] = end;
+        nextOperation[bestJob]++;
+        makespan = std::max(makespan, end);
+    }
+
+    return JspSchedule{ startTimes, makespan };
+}
+
+JspSchedule JspHeuristics::gifflerThompsonSchedule(const JSPLIBInstance& instance, DispatchRule rule, double tieTolerance,
+                                                  std::mt19937& rng) {
+    vector<vector<int>> startTimes(instance.numberOfJobs, vector<int>(instance.numberOfMachines, 0));
+    vector<int> nextOperation(instance.numberOfJobs, 0);
+    vector<int> jobReady(instance.numberOfJobs, 0);
+    vector<int> machineReady(instance.numberOfMachines, 0);
+
+    vector<int> remainingWork(instance.numberOfJobs, 0); // work of the unscheduled operations, current one included
+    for (int jobID = 0; jobID < instance.numberOfJobs; jobID++) {
+        for (int machineID = 0; machineID < instance.numberOfMachines; machineID++) {
+            remainingWork[jobID] += instance.durationsMatrix[jobID][machineID];
+        }
+    }
+
+    vector<int> conflictSet;
+    conflictSet.reserve(instance.numberOfJobs);
+
+    int makespan = 0;
+    for (int scheduled = 0; scheduled < instance.numberOfJobs * instance.numberOfMachines; scheduled++) {
+        // Operation with the earliest completion time decides the machine.
+        int minCompletion = std::numeric_limits<int>::max();
+        int conflictMachine = -1;
+        int conflictJob = -1;
+        for (int jobID = 0; jobID < instance.numberOfJobs; jobID++) {
+            if (nextOperation[jobID] == instance.numberOfMachines) {
+                continue;
+            }
+            int machineID = instance.precedencesMatrix[jobID][nextOperation[jobID]];
+            int completion = std::max(jobReady[jobID], machineReady[machineID]) + instance.durationsMatrix[jobID][machineID];
+            if (completion < minCompletion) {
+                minCompletion = completion;
+                conflictMachine = machineID;
+                conflictJob = jobID;
+            }
+        }
+
+        // Operations on that machine which could start before it completes, always including it
+        // (with duration 0 it starts at minCompletion).
+        conflictSet.clear();
+        for (int jobID = 0; jobID < instance.numberOfJobs; jobID++) {
+            if (nextOperation[jobID] == instance.numberOfMachines
+                || instance.precedencesMatrix[jobID][nextOperation[jobID]] != conflictMachine) {
+                continue;
+            }
+            if (jobID == conflictJob || std::max(jobReady[jobID], machineReady[conflictMachine]) < minCompletion) {
+                conflictSet.push_back(jobID);
+            }
+        }
+
+        auto priority = [&](int jobID) {
+            int duration = instance.durationsMatrix[jobID][conflictMachine];
+            switch (rule) {
+            case DispatchRule::SPT:  return -duration;
+            case DispatchRule::MWKR: return remainingWork[jobID];
+            case DispatchRule::LRPT: return remainingWork[jobID] - duration;
+            }
+            return 0;
+        };
+
+        // Random tie-break among the jobs whose priority is within tieTolerance of the priority range from the best.
+        int maxPriority = std::numeric_limits<int>::min();
+        int minPriority = std::numeric_limits<int>::max();
+        for (int jobID : conflictSet) {
+            maxPriority = std::max(maxPriority, priority(jobID));
+            minPriority = std::min(minPriority, priority(jobID));
+        }
+        double threshold = maxPriority - tieTolerance * (maxPriority - minPriority);
+
+        int selectedJob = -1;
+        int ties = 0;
+        for (int jobID : conflictSet) {
+            if (priority(jobID) >= threshold && std::uniform_int_distribution<int>(0, ties++)(rng) == 0) {
+                selectedJob = jobID;
+            }
+        }
+
+        int duration = instance.durationsMatrix[selectedJob][conflictMachine];
+        int start = std::max(jobReady[selectedJob], machineReady[conflictMachine]);
+        startTimes[selectedJob][conflictMachine] = start;
+        jobReady[selectedJob] = start + duration;
+        machineReady[conflictMachine] = start + duration;
+        remainingWork[selectedJob] -= duration;
+        nextOperation[selectedJob]++;
+        makespan = std::max(makespan, start + duration);
+    }
+
+    return JspSchedule{ startTimes, makespan };
+}
+
+JspSchedule JspHeuristics::bestDispatchSchedule(const JSPLIBInstance& instance, int iterations, unsigned int seed) {
+    const DispatchRule rules[] = { DispatchRule::SPT, DispatchRule::MWKR, DispatchRule::LRPT };
+    const double tieTolerances[] = { 0.0, 0.1, 0.2, 0.3 };
+    std::mt19937 rng(seed);
+
+    JspSchedule best = earliestStartSchedule(instance);
+    for (int i = 0; i < iterations; i++) {
+        JspSchedule schedule = gifflerThompsonSchedule(instance, rules[i % 3], tieTolerances[(i / 3) % 4], rng);
+        if (schedule.makespan < best.makespan) {
+            best = std::move(schedule);
+        }
+    }
+    return best;
+}
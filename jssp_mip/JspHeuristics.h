@@ -0,0 +1,31 @@
+#pragma once
+
+#include "JspInstance.h"
+
+#include <random>
+
+
+enum class DispatchRule {
+    SPT,  // shortest processing time of the operation
+    MWKR, // most work remaining in the job, operation included
+    LRPT  // longest remaining processing time in the job after the operation
+};
+
+
+/**
+ Constructive heuristics producing feasible JSP schedules, used as upper bounds and MIP starts.
+ */
+class JspHeuristics {
+
+public:
+    // Repeatedly schedules the next operation of the job that can start earliest.
+    static JspSchedule earliestStartSchedule(const JSPLIBInstance& instance);
+
+    // Giffler-Thompson active schedule, conflicts are resolved by the rule and ties broken at random.
+    // Priorities within tieTolerance * (max - min priority) of the best one count as ties.
+    static JspSchedule gifflerThompsonSchedule(const JSPLIBInstance& instance, DispatchRule rule, double tieTolerance,
+                                               std::mt19937& rng);
+
+    // Best of the earliest start schedule and 'iterations' Giffler-Thompson runs cycling through rules and tolerances.
+    static JspSchedule bestDispatchSchedule(const JSPLIBInstance& instance, int iterations, unsigned int seed);
+};
@@ -14,4 +14,10 @@ struct JSPLIBInstance {
     std::vector< std::vector<int>> durationsMatrix;
 };
 
-
+struct JspSchedule {
+    /// <summary>
+    /// Feasible job shop schedule, start times are indexed the same way as durationsMatrix.
+    /// </summary>
+    std::vector< std::vector<int>> startTimes; // startTimes[jobID][machineID]
+    int makespan;
+};
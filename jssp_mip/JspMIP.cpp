@@ -1,77 +1,172 @@
 #pragma once
 
 #include "LoaderJSPLIB.h"
+#include "InstanceCache.h"
 #include "JspMIP.h"
+#include "JspBounds.h"
+#include "JspHeuristics.h"
+#include "JspTabuSearch.h"
+#include "JspCallback.h"
+#include "ModelBuilder.h"
 
 #include "gurobi_c++.h"
 
 #include <numeric>
 #include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <string>
+#include <thread>
+#include <vector>
 
 using std::string;
+using std::vector;
 using std::cout;
 using std::endl;
 
 
+namespace {
+
+// Start times of the incumbent rounded to integers, empty if the model has no solution.
+template <typename StartOf>
+vector<vector<int>> readStartTimes(GRBModel& model, const JSPLIBInstance& instance, StartOf startOf) {
+    if (model.get(GRB_IntAttr_SolCount) == 0) {
+        return {};
+    }
+    vector<vector<int>> startTimes(instance.numberOfJobs, vector<int>(instance.numberOfMachines));
+    for (int jobID = 0; jobID < instance.numberOfJobs; jobID++) {
+        for (int machineID = 0; machineID < instance.numberOfMachines; machineID++) {
+            startTimes[jobID][machineID] = (int)std::lround(startOf(jobID, machineID));
+        }
+    }
+    return startTimes;
+}
+
+}
+
+
 void JspMIP::solveInstance(const char* instancePath, float timeLimit) {
-    // "Disjunctive model" as given in 
+    result = SolveResult{ instancePath };
 
     // ------ Load JSP instance and create bounds. ---------------
-    const JSPLIBInstance instance = LoaderJSPLIB::loadInstance(instancePath);
+    const JSPLIBInstance instance = InstanceCache::loadJsp(instancePath);
 
-    int minCmax = 0;
-    int bigM = 0;
+    const vector<vector<int>> heads = JspBounds::computeHeads(instance);
+    const vector<vector<int>> tails = JspBounds::computeTails(instance);
 
-    for (int i = 0; i < instance.numberOfJobs; i++) {
-        int sum = std::accumulate(std::begin(instance.durationsMatrix[i]), std::end(instance.durationsMatrix[i]), 0);
+    // One-machine relaxations, the job bound alone ignores machine load.
+    const int minCmax = JspBounds::lowerBound(instance, heads, tails);
 
-        minCmax = std::max(sum, minCmax);
+    // Any optimal schedule has Cmax <= maxCmax, which bounds every start time and every big-M.
+    const JspSchedule heuristicSchedule = JspHeuristics::bestDispatchSchedule(instance, params.dispatchIterations, params.seed);
+    const int maxCmax = heuristicSchedule.makespan;
 
-        bigM += sum;
-    }
-
-    cout << '\n';
+    cout << "Cmax bounds: [" << minCmax << ", " << maxCmax << "]" << '\n';
 
     // ------ Gurobi model. ---------------
-    GRBEnv* env = new GRBEnv();
-    GRBModel model = GRBModel(*env);
+    GRBModel model = GRBModel(getEnv());
+    model.set(GRB_IntParam_Threads, threads);
     model.set(GRB_IntAttr_ModelSense, GRB_MINIMIZE);
     model.set(GRB_StringAttr_ModelName, "JSPLib MIP solver");
     model.set(GRB_DoubleParam_TimeLimit, timeLimit);
 
+    vector<vector<int>> startTimes;
+    switch (params.formulation) {
+    case JspFormulation::Disjunctive:
+        startTimes = disjunctiveFormulation(model, instance, heads, tails, minCmax, heuristicSchedule);
+        break;
+    case JspFormulation::TimeIndexed:
+        startTimes = timeIndexedFormulation(model, instance, heads, tails, minCmax, heuristicSchedule);
+        break;
+    case JspFormulation::RankBased:
+        startTimes = rankBasedFormulation(model, instance, heads, tails, minCmax, heuristicSchedule);
+        break;
+    }
 
-    // ------ Variables. ---------------
-    GRBVar Cmax = model.addVar(minCmax, GRB_INFINITY, 1, GRB_CONTINUOUS, "Cmax"); // lb, ub, obj, type, name
+    recordResult(model);
 
-    GRBVar** x = new GRBVar * [instance.numberOfJobs]; // x[jobID][machineID] = start of job on machine
-    for (int i = 0; i < instance.numberOfJobs; i++) {
-        x[i] = new GRBVar[instance.numberOfMachines];
+    int status = model.get(GRB_IntAttr_Status);
+    if (model.get(GRB_IntAttr_SolCount) > 0) {
+        cout << "\n==================================" << endl;
+        cout << "Cmax: " << model.get(GRB_DoubleAttr_ObjVal) << (status == GRB_OPTIMAL ? " (optimal)" : "") << endl;
+        cout << "lower bound: " << model.get(GRB_DoubleAttr_ObjBound) << endl;
+        for (int i = 0; i < instance.numberOfJobs; i++) {
+            for (int j = 0; j < instance.numberOfMachines; j++) {
+                cout << startTimes[i][j] << " ";
+            }
+            cout << endl;
+        }
+        cout << "==================================\n";
     }
+    else if (status == GRB_INFEASIBLE) {
+        model.computeIIS();
+        model.write("jsp_model_IIS.ilp");
+    }
+
+}
+
+
+vector<vector<int>> JspMIP::disjunctiveFormulation(GRBModel& model, const JSPLIBInstance& instance,
+                                                   const vector<vector<int>>& heads, const vector<vector<int>>& tails,
+                                                   int minCmax, const JspSchedule& heuristicSchedule) {
+    // "Disjunctive model" (Manne): start times x and one ordering binary z per disjunction.
+    const int maxCmax = heuristicSchedule.makespan;
+
+    ModelBuilder builder(model);
+
+    // ------ Variables. ---------------
+    int CmaxIdx = builder.queueVar(minCmax, maxCmax, 1, GRB_CONTINUOUS, [] { return string("Cmax"); }); // lb, ub, obj, type, name
+
+    vector<vector<int>> xIdx(instance.numberOfJobs, vector<int>(instance.numberOfMachines)); // x[jobID][machineID] = start of job on machine
     for (int i = 0; i < instance.numberOfJobs; i++) {
         for (int j = 0; j < instance.numberOfMachines; j++) {
-            string name = "x" + std::to_string(i) + std::to_string(j);
-            x[i][j] = model.addVar(0, GRB_INFINITY, 0, GRB_INTEGER, name);
+            int latestStart = maxCmax - tails[i][j] - instance.durationsMatrix[i][j];
+            xIdx[i][j] = builder.queueVar(heads[i][j], latestStart, 0, GRB_INTEGER,
+                                          [&] { return "x" + std::to_string(i) + std::to_string(j); });
         }
     }
 
-    GRBVar*** z = new GRBVar * *[instance.numberOfMachines];
+    // z[machineID][j][k] == 1 iff job j is processed before job k on the machine.
+    // Pairwise mode creates only j < k, one binary per disjunction; otherwise every ordered pair j != k.
+    vector<vector<vector<int>>> zIdx(instance.numberOfMachines, vector<vector<int>>(instance.numberOfJobs, vector<int>(instance.numberOfJobs, -1)));
     for (int i = 0; i < instance.numberOfMachines; i++) {
-        z[i] = new GRBVar * [instance.numberOfJobs];
         for (int j = 0; j < instance.numberOfJobs; j++) {
-            z[i][j] = new GRBVar[instance.numberOfJobs];
+            int kStart = params.pairwiseDisjunctions ? j + 1 : 0;
+            for (int k = kStart; k < instance.numberOfJobs; k++) {
+                if (j == k) {
+                    continue;
+                }
+                zIdx[i][j][k] = builder.queueVar(0, 1, 0, GRB_BINARY,
+                                                 [&] { return "z" + std::to_string(i) + std::to_string(j) + std::to_string(k); });
+            }
         }
     }
 
+    GRBVar* vars = builder.addQueuedVars();
+
+    GRBVar Cmax = vars[CmaxIdx];
+
+    GRBVar** x = new GRBVar * [instance.numberOfJobs];
+    for (int i = 0; i < instance.numberOfJobs; i++) {
+        x[i] = new GRBVar[instance.numberOfMachines];
+        for (int j = 0; j < instance.numberOfMachines; j++) {
+            x[i][j] = vars[xIdx[i][j]];
+        }
+    }
 
+    GRBVar*** z = new GRBVar * *[instance.numberOfMachines];
     for (int i = 0; i < instance.numberOfMachines; i++) {
+        z[i] = new GRBVar * [instance.numberOfJobs];
         for (int j = 0; j < instance.numberOfJobs; j++) {
+            z[i][j] = new GRBVar[instance.numberOfJobs];
             for (int k = 0; k < instance.numberOfJobs; k++) {
-                string name = "z" + std::to_string(i) + std::to_string(j) + std::to_string(k);
-                z[i][j][k] = model.addVar(0, 1, 0, GRB_BINARY, name);
+                if (zIdx[i][j][k] >= 0) {
+                    z[i][j][k] = vars[zIdx[i][j][k]];
+                }
             }
         }
     }
+    delete[] vars;
 
 
     // ------ Constraints. ---------------
@@ -79,48 +174,366 @@ void JspMIP::solveInstance(const char* instancePath, float timeLimit) {
         for (int i = 1; i < instance.numberOfMachines; i++) {
             int machineIDprev = instance.precedencesMatrix[jobID][i - 1];
             int machineID = instance.precedencesMatrix[jobID][i];
-            model.addConstr(x[jobID][machineID] >= x[jobID][machineIDprev] + instance.durationsMatrix[jobID][machineIDprev]);
+            builder.queueConstr(x[jobID][machineID] - x[jobID][machineIDprev], GRB_GREATER_EQUAL, instance.durationsMatrix[jobID][machineIDprev]);
         }
     }
 
     for (int jobID = 0; jobID < instance.numberOfJobs; jobID++) {
         int lastMachineID = instance.precedencesMatrix[jobID][instance.numberOfMachines - 1];
-        model.addConstr(Cmax >= x[jobID][lastMachineID] + instance.durationsMatrix[jobID][lastMachineID]);
+        builder.queueConstr(Cmax - x[jobID][lastMachineID], GRB_GREATER_EQUAL, instance.durationsMatrix[jobID][lastMachineID]);
     }
 
-    for (int machineID = 0; machineID < instance.numberOfMachines; machineID++) {
-        for (int j = 0; j < instance.numberOfJobs; j++) {
-            for (int k = 0; k < instance.numberOfJobs; k++) {
-                if (j == k) {
-                    continue;
+    // In lazy mode the binaries exist up front (callbacks cannot add columns), the rows come from the callback.
+    if (!params.lazyDisjunctions) {
+        for (int machineID = 0; machineID < instance.numberOfMachines; machineID++) {
+            for (int j = 0; j < instance.numberOfJobs; j++) {
+                int kStart = params.pairwiseDisjunctions ? j + 1 : 0;
+                for (int k = kStart; k < instance.numberOfJobs; k++) {
+                    if (j == k) {
+                        continue;
+                    }
+                    int bigMkj = JspBounds::disjunctiveBigM(heads, tails, maxCmax, machineID, k, j);
+                    int bigMjk = JspBounds::disjunctiveBigM(heads, tails, maxCmax, machineID, j, k);
+                    // x_j >= x_k + p_k - M_kj z  and  x_k >= x_j + p_j - M_jk (1 - z)
+                    builder.queueConstr(x[j][machineID] - x[k][machineID] + bigMkj * z[machineID][j][k],
+                                        GRB_GREATER_EQUAL, instance.durationsMatrix[k][machineID]);
+                    builder.queueConstr(x[k][machineID] - x[j][machineID] - bigMjk * z[machineID][j][k],
+                                        GRB_GREATER_EQUAL, instance.durationsMatrix[j][machineID] - bigMjk);
                 }
-                model.addConstr(x[j][machineID] >= x[k][machineID] + instance.durationsMatrix[k][machineID] - bigM * z[machineID][j][k]);
-                model.addConstr(x[k][machineID] >= x[j][machineID] + instance.durationsMatrix[j][machineID] - bigM * (1 - z[machineID][j][k]));
             }
         }
     }
 
+    builder.addQueuedConstrs();
 
-    //------- Solve the model. -----------
-    model.optimize();
 
-    if (model.get(GRB_IntAttr_Status) == GRB_OPTIMAL) {
-        cout << "\n==================================" << endl;
-        cout << "Cmax: " << model.get(GRB_DoubleAttr_ObjVal) << endl;
-        for (int i = 0; i < instance.numberOfMachines; i++) {
+    //------- MIP start from the heuristic schedule. -----------
+    if (params.warmStart) {
+        const vector<vector<int>>& start = heuristicSchedule.startTimes;
+
+        Cmax.set(GRB_DoubleAttr_Start, heuristicSchedule.makespan);
+        for (int i = 0; i < instance.numberOfJobs; i++) {
             for (int j = 0; j < instance.numberOfMachines; j++) {
-                cout << x[i][j].get(GRB_DoubleAttr_X) << " ";
+                x[i][j].set(GRB_DoubleAttr_Start, start[i][j]);
+            }
+        }
+        for (int i = 0; i < instance.numberOfMachines; i++) {
+            for (int j = 0; j < instance.numberOfJobs; j++) {
+                int kStart = params.pairwiseDisjunctions ? j + 1 : 0;
+                for (int k = kStart; k < instance.numberOfJobs; k++) {
+                    if (j == k) {
+                        continue;
+                    }
+                    z[i][j][k].set(GRB_DoubleAttr_Start, start[j][i] < start[k][i] ? 1 : 0);
+                }
             }
-            cout << endl;
         }
-        cout << "==================================\n";
     }
-    else {
-        model.computeIIS();
-        model.write("jsp_model_IIS.ilp");
+
+
+    //------- Tabu search feeding incumbents through the callback. -----------
+    JspCallback callback(instance, Cmax, x, z, params.pairwiseDisjunctions);
+    model.setCallback(&callback);
+
+    if (params.lazyDisjunctions) {
+        model.set(GRB_IntParam_LazyConstraints, 1);
+        callback.enableLazyDisjunctions(heads, tails, maxCmax);
+    }
+
+    std::atomic<bool> stopTabuSearch(false);
+    JspSchedule tabuSchedule = heuristicSchedule;
+    std::thread tabuThread;
+    if (params.tabuSearch) {
+        // The tabu search thread is part of the budget, Gurobi gets the rest.
+        int budget = threads > 0 ? threads : std::max(1, (int)std::thread::hardware_concurrency());
+        model.set(GRB_IntParam_Threads, std::max(1, budget - 1));
+        tabuThread = std::thread([&]() {
+            JspTabuSearch tabuSearch(instance, params.seed);
+            tabuSchedule = tabuSearch.run(heuristicSchedule, stopTabuSearch, 0,
+                [&](const JspSchedule& schedule) { callback.offerSchedule(schedule); });
+        });
+    }
+
+
+    // The thread must be joined before it goes out of scope, also when optimize throws.
+    auto stopTabuThread = [&]() {
+        stopTabuSearch = true;
+        if (tabuThread.joinable()) {
+            tabuThread.join();
+        }
+    };
+
+
+    //------- Solve the model. -----------
+    try {
+        model.optimize();
+    }
+    catch (...) {
+        stopTabuThread();
+        throw;
+    }
+
+    if (tabuThread.joinable()) {
+        stopTabuThread();
+        cout << "tabu search best Cmax: " << tabuSchedule.makespan << endl;
+    }
+
+    return readStartTimes(model, instance, [&](int jobID, int machineID) { return x[jobID][machineID].get(GRB_DoubleAttr_X); });
+}
+
+
+vector<vector<int>> JspMIP::timeIndexedFormulation(GRBModel& model, const JSPLIBInstance& instance,
+                                                   const vector<vector<int>>& heads, const vector<vector<int>>& tails,
+                                                   int minCmax, const JspSchedule& heuristicSchedule) {
+    // Time-indexed model: x[jobID][machineID][t] == 1 iff the operation starts at time t.
+    // Start times are limited to [head, maxCmax - tail - p], the horizon is the heuristic makespan.
+    const int maxCmax = heuristicSchedule.makespan;
+    const int n = instance.numberOfJobs;
+    const int m = instance.numberOfMachines;
+
+    ModelBuilder builder(model);
+
+    // ------ Variables. ---------------
+    int CmaxIdx = builder.queueVar(minCmax, maxCmax, 1, GRB_CONTINUOUS, [] { return string("Cmax"); });
+
+    vector<vector<int>> firstIdx(n, vector<int>(m)); // index of x[jobID][machineID][earliest start]
+    for (int jobID = 0; jobID < n; jobID++) {
+        for (int machineID = 0; machineID < m; machineID++) {
+            int latestStart = maxCmax - tails[jobID][machineID] - instance.durationsMatrix[jobID][machineID];
+            for (int t = heads[jobID][machineID]; t <= latestStart; t++) {
+                int idx = builder.queueVar(0, 1, 0, GRB_BINARY,
+                    [&] { return "x" + std::to_string(jobID) + "_" + std::to_string(machineID) + "_" + std::to_string(t); });
+                if (t == heads[jobID][machineID]) {
+                    firstIdx[jobID][machineID] = idx;
+                }
+            }
+        }
     }
 
+    GRBVar* vars = builder.addQueuedVars();
+    GRBVar Cmax = vars[CmaxIdx];
+
+    auto latestStartOf = [&](int jobID, int machineID) {
+        return maxCmax - tails[jobID][machineID] - instance.durationsMatrix[jobID][machineID];
+    };
+    auto x = [&](int jobID, int machineID, int t) {
+        return vars[firstIdx[jobID][machineID] + t - heads[jobID][machineID]];
+    };
+    auto startExpr = [&](int jobID, int machineID) {
+        GRBLinExpr expr = 0;
+        for (int t = heads[jobID][machineID]; t <= latestStartOf(jobID, machineID); t++) {
+            expr += t * x(jobID, machineID, t);
+        }
+        return expr;
+    };
+
+
+    // ------ Constraints. ---------------
+    for (int jobID = 0; jobID < n; jobID++) {
+        for (int machineID = 0; machineID < m; machineID++) {
+            GRBLinExpr expr = 0;
+            for (int t = heads[jobID][machineID]; t <= latestStartOf(jobID, machineID); t++) {
+                expr += x(jobID, machineID, t);
+            }
+            builder.queueConstr(std::move(expr), GRB_EQUAL, 1);
+        }
+    }
+
+    // At most one operation in process on a machine at time t.
+    for (int machineID = 0; machineID < m; machineID++) {
+        for (int t = 0; t < maxCmax; t++) {
+            GRBLinExpr expr = 0;
+            int terms = 0;
+            for (int jobID = 0; jobID < n; jobID++) {
+                int from = std::max(heads[jobID][machineID], t - instance.durationsMatrix[jobID][machineID] + 1);
+                int to = std::min(latestStartOf(jobID, machineID), t);
+                for (int s = from; s <= to; s++) {
+                    expr += x(jobID, machineID, s);
+                    terms++;
+                }
+            }
+            if (terms > 1) {
+                builder.queueConstr(std::move(expr), GRB_LESS_EQUAL, 1);
+            }
+        }
+    }
+
+    for (int jobID = 0; jobID < n; jobID++) {
+        for (int i = 1; i < m; i++) {
+            int machineIDprev = instance.precedencesMatrix[jobID][i - 1];
+            int machineID = instance.precedencesMatrix[jobID][i];
+            builder.queueConstr(startExpr(jobID, machineID) - startExpr(jobID, machineIDprev),
+                                GRB_GREATER_EQUAL, instance.durationsMatrix[jobID][machineIDprev]);
+        }
+        int lastMachineID = instance.precedencesMatrix[jobID][m - 1];
+        builder.queueConstr(Cmax - startExpr(jobID, lastMachineID), GRB_GREATER_EQUAL, instance.durationsMatrix[jobID][lastMachineID]);
+    }
+
+    builder.addQueuedConstrs();
+
+
+    //------- MIP start from the heuristic schedule. -----------
+    if (params.warmStart) {
+        Cmax.set(GRB_DoubleAttr_Start, heuristicSchedule.makespan);
+        for (int jobID = 0; jobID < n; jobID++) {
+            for (int machineID = 0; machineID < m; machineID++) {
+                for (int t = heads[jobID][machineID]; t <= latestStartOf(jobID, machineID); t++) {
+                    x(jobID, machineID, t).set(GRB_DoubleAttr_Start, heuristicSchedule.startTimes[jobID][machineID] == t ? 1 : 0);
+                }
+            }
+        }
+    }
+
+
+    //------- Solve the model. -----------
+    model.optimize();
+
+    vector<vector<int>> startTimes = readStartTimes(model, instance, [&](int jobID, int machineID) {
+        for (int t = heads[jobID][machineID]; t <= latestStartOf(jobID, machineID); t++) {
+            if (x(jobID, machineID, t).get(GRB_DoubleAttr_X) > 0.5) {
+                return (double)t;
+            }
+        }
+        return 0.0;
+    });
+    delete[] vars;
+    return startTimes;
 }
 
 
+vector<vector<int>> JspMIP::rankBasedFormulation(GRBModel& model, const JSPLIBInstance& instance,
+                                                 const vector<vector<int>>& heads, const vector<vector<int>>& tails,
+                                                 int minCmax, const JspSchedule& heuristicSchedule) {
+    // Rank-based model (Wagner): y[machineID][jobID][r] == 1 iff the job is r-th on the machine,
+    // h[machineID][r] = start of the r-th position, s[jobID][machineID] = start of the operation.
+    const int maxCmax = heuristicSchedule.makespan;
+    const int n = instance.numberOfJobs;
+    const int m = instance.numberOfMachines;
+
+    ModelBuilder builder(model);
+
+    // ------ Variables. ---------------
+    int CmaxIdx = builder.queueVar(minCmax, maxCmax, 1, GRB_CONTINUOUS, [] { return string("Cmax"); });
+
+    vector<vector<vector<int>>> yIdx(m, vector<vector<int>>(n, vector<int>(n)));
+    for (int machineID = 0; machineID < m; machineID++) {
+        for (int jobID = 0; jobID < n; jobID++) {
+            for (int r = 0; r < n; r++) {
+                yIdx[machineID][jobID][r] = builder.queueVar(0, 1, 0, GRB_BINARY,
+                    [&] { return "y" + std::to_string(machineID) + "_" + std::to_string(jobID) + "_" + std::to_string(r); });
+            }
+        }
+    }
+
+    vector<vector<int>> hIdx(m, vector<int>(n));
+    for (int machineID = 0; machineID < m; machineID++) {
+        for (int r = 0; r < n; r++) {
+            hIdx[machineID][r] = builder.queueVar(0, maxCmax, 0, GRB_CONTINUOUS,
+                [&] { return "h" + std::to_string(machineID) + "_" + std::to_string(r); });
+        }
+    }
+
+    vector<vector<int>> sIdx(n, vector<int>(m));
+    for (int jobID = 0; jobID < n; jobID++) {
+        for (int machineID = 0; machineID < m; machineID++) {
+            int latestStart = maxCmax - tails[jobID][machineID] - instance.durationsMatrix[jobID][machineID];
+            sIdx[jobID][machineID] = builder.queueVar(heads[jobID][machineID], latestStart, 0, GRB_INTEGER,
+                [&] { return "s" + std::to_string(jobID) + "_" + std::to_string(machineID); });
+        }
+    }
+
+    GRBVar* vars = builder.addQueuedVars();
+    GRBVar Cmax = vars[CmaxIdx];
+    auto y = [&](int machineID, int jobID, int r) { return vars[yIdx[machineID][jobID][r]]; };
+    auto h = [&](int machineID, int r) { return vars[hIdx[machineID][r]]; };
+    auto s = [&](int jobID, int machineID) { return vars[sIdx[jobID][machineID]]; };
+
 
+    // ------ Constraints. ---------------
+    for (int machineID = 0; machineID < m; machineID++) {
+        for (int jobID = 0; jobID < n; jobID++) {
+            GRBLinExpr expr = 0;
+            for (int r = 0; r < n; r++) {
+                expr += y(machineID, jobID, r);
+            }
+            builder.queueConstr(std::move(expr), GRB_EQUAL, 1);
+        }
+        for (int r = 0; r < n; r++) {
+            GRBLinExpr expr = 0;
+            for (int jobID = 0; jobID < n; jobID++) {
+                expr += y(machineID, jobID, r);
+            }
+            builder.queueConstr(std::move(expr), GRB_EQUAL, 1);
+        }
+    }
+
+    // Position r + 1 starts after the job in position r completes, the last position bounds Cmax.
+    for (int machineID = 0; machineID < m; machineID++) {
+        for (int r = 0; r < n; r++) {
+            GRBLinExpr completion = h(machineID, r);
+            for (int jobID = 0; jobID < n; jobID++) {
+                completion += instance.durationsMatrix[jobID][machineID] * y(machineID, jobID, r);
+            }
+            if (r + 1 < n) {
+                builder.queueConstr(h(machineID, r + 1) - completion, GRB_GREATER_EQUAL, 0);
+            }
+            else {
+                builder.queueConstr(Cmax - completion, GRB_GREATER_EQUAL, 0);
+            }
+        }
+    }
+
+    // s[jobID][machineID] == h[machineID][r] when y[machineID][jobID][r] == 1.
+    for (int machineID = 0; machineID < m; machineID++) {
+        for (int jobID = 0; jobID < n; jobID++) {
+            for (int r = 0; r < n; r++) {
+                builder.queueConstr(s(jobID, machineID) - h(machineID, r) + maxCmax * y(machineID, jobID, r), GRB_LESS_EQUAL, maxCmax);
+                builder.queueConstr(s(jobID, machineID) - h(machineID, r) - maxCmax * y(machineID, jobID, r), GRB_GREATER_EQUAL, -maxCmax);
+            }
+        }
+    }
+
+    for (int jobID = 0; jobID < n; jobID++) {
+        for (int i = 1; i < m; i++) {
+            int machineIDprev = instance.precedencesMatrix[jobID][i - 1];
+            int machineID = instance.precedencesMatrix[jobID][i];
+            builder.queueConstr(s(jobID, machineID) - s(jobID, machineIDprev), GRB_GREATER_EQUAL, instance.durationsMatrix[jobID][machineIDprev]);
+        }
+        int lastMachineID = instance.precedencesMatrix[jobID][m - 1];
+        builder.queueConstr(Cmax - s(jobID, lastMachineID), GRB_GREATER_EQUAL, instance.durationsMatrix[jobID][lastMachineID]);
+    }
+
+    builder.addQueuedConstrs();
+
+
+    //------- MIP start from the heuristic schedule. -----------
+    if (params.warmStart) {
+        const vector<vector<int>>& start = heuristicSchedule.startTimes;
+
+        Cmax.set(GRB_DoubleAttr_Start, heuristicSchedule.makespan);
+        vector<int> jobsByStart(n);
+        for (int machineID = 0; machineID < m; machineID++) {
+            std::iota(jobsByStart.begin(), jobsByStart.end(), 0);
+            std::sort(jobsByStart.begin(), jobsByStart.end(), [&](int a, int b) { return start[a][machineID] < start[b][machineID]; });
+            for (int r = 0; r < n; r++) {
+                h(machineID, r).set(GRB_DoubleAttr_Start, start[jobsByStart[r]][machineID]);
+                for (int jobID = 0; jobID < n; jobID++) {
+                    y(machineID, jobID, r).set(GRB_DoubleAttr_Start, jobsByStart[r] == jobID ? 1 : 0);
+                }
+            }
+            for (int jobID = 0; jobID < n; jobID++) {
+                s(jobID, machineID).set(GRB_DoubleAttr_Start, start[jobID][machineID]);
+            }
+        }
+    }
+
+
+    //------- Solve the model. -----------
+    model.optimize();
+
+    vector<vector<int>> startTimes = readStartTimes(model, instance, [&](int jobID, int machineID) {
+        return s(jobID, machineID).get(GRB_DoubleAttr_X);
+    });
+    delete[] vars;
+    return startTimes;
+}
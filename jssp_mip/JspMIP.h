@@ -1,9 +1,56 @@
 #pragma once
 
 #include "ModelMIP.h"
+#include "JspInstance.h"
+
+#include <vector>
+
+
+class GRBModel;
+
+enum class JspFormulation {
+    Disjunctive, // Manne: start times and ordering binaries per machine
+    TimeIndexed, // one binary per operation and start time, suits short horizons
+    RankBased    // Wagner: position of every job on every machine
+};
+
+
+struct JspMIPParams {
+    /// <summary>
+    /// Formulation switches of the JSP MIP model.
+    /// </summary>
+    JspFormulation formulation = JspFormulation::Disjunctive;
+    bool pairwiseDisjunctions = true; // one ordering binary per unordered pair j < k, otherwise per ordered pair j != k
+    bool warmStart = true;            // load the best dispatching schedule as MIP start
+    int dispatchIterations = 300;     // Giffler-Thompson runs with random tie-breaks
+    unsigned int seed = 0;
+    bool tabuSearch = true;           // disjunctive only: run tabu search in a background thread and inject its improvements
+    bool lazyDisjunctions = false;    // disjunctive only: add disjunctive rows only once an incumbent violates them
+};
 
 class JspMIP : public ModelMIP{
+private:
+	JspMIPParams params;
+
+	// Each formulation builds, warm starts and solves the model, returns the incumbent start times (empty if none).
+	std::vector<std::vector<int>> disjunctiveFormulation(GRBModel& model, const JSPLIBInstance& instance,
+	                                                     const std::vector<std::vector<int>>& heads,
+	                                                     const std::vector<std::vector<int>>& tails,
+	                                                     int minCmax, const JspSchedule& heuristicSchedule);
+
+	std::vector<std::vector<int>> timeIndexedFormulation(GRBModel& model, const JSPLIBInstance& instance,
+	                                                     const std::vector<std::vector<int>>& heads,
+	                                                     const std::vector<std::vector<int>>& tails,
+	                                                     int minCmax, const JspSchedule& heuristicSchedule);
+
+	std::vector<std::vector<int>> rankBasedFormulation(GRBModel& model, const JSPLIBInstance& instance,
+	                                                   const std::vector<std::vector<int>>& heads,
+	                                                   const std::vector<std::vector<int>>& tails,
+	                                                   int minCmax, const JspSchedule& heuristicSchedule);
 
 public:
+	JspMIP() = default;
+	explicit JspMIP(const JspMIPParams& params) : params(params) {}
+
 	void solveInstance(const char* instancePath, float timeLimit);
 };
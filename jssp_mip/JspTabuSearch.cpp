@@ -0,0 +1,344 @@
+#pragma once
+
+#include "JspTabuSearch.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+
+using std::vector;
+
+
+JspTabuSearch::JspTabuSearch(const JSPLIBInstance& instance, unsigned int seed)
+    : instance(instance), numberOfOperations(instance.numberOfJobs * instance.numberOfMachines), rng(seed) {
+
+    machineOf.resize(numberOfOperations);
+    durationOf.resize(numberOfOperations);
+    for (int jobID = 0; jobID < instance.numberOfJobs; jobID++) {
+        for (int i = 0; i < instance.numberOfMachines; i++) {
+            int op = jobID * instance.numberOfMachines + i;
+            machineOf[op] = instance.precedencesMatrix[jobID][i];
+            durationOf[op] = instance.durationsMatrix[jobID][machineOf[op]];
+        }
+    }
+
+    sequences.assign(instance.numberOfMachines, vector<int>());
+    machinePosition.assign(numberOfOperations, 0);
+    heads.assign(numberOfOperations, 0);
+    tails.assign(numberOfOperations, 0);
+    topologicalOrder.reserve(numberOfOperations);
+    tabuUntil.assign((size_t)numberOfOperations * numberOfOperations, 0);
+}
+
+void JspTabuSearch::loadSchedule(const JspSchedule& schedule) {
+    for (auto& sequence : sequences) {
+        sequence.clear();
+    }
+    for (int op = 0; op < numberOfOperations; op++) {
+        sequences[machineOf[op]].push_back(op);
+    }
+    for (auto& sequence : sequences) {
+        std::sort(sequence.begin(), sequence.end(), [&](int a, int b) {
+            int jobA = a / instance.numberOfMachines, jobB = b / instance.numberOfMachines;
+            return schedule.startTimes[jobA][machineOf[a]] < schedule.startTimes[jobB][machineOf[b]];
+        });
+        for (int pos = 0; pos < (int)sequence.size(); pos++) {
+            machinePosition[sequence[pos]] = pos;
+        }
+    }
+}
+
+JspSchedule JspTabuSearch::currentSchedule(int makespan) const {
+    vector<vector<int>> startTimes(instance.numberOfJobs, vector<int>(instance.numberOfMachines, 0));
+    for (int op = 0; op < numberOfOperations; op++) {
+        startTimes[op / instance.numberOfMachines][machineOf[op]] = heads[op];
+    }
+    return JspSchedule{ startTimes, makespan };
+}
+
+int JspTabuSearch::evaluate() {
+    // Longest paths in the disjunctive graph, returns -1 if the machine sequences create a cycle.
+    const int m = instance.numberOfMachines;
+    vector<int> inDegree(numberOfOperations, 0);
+    for (int op = 0; op < numberOfOperations; op++) {
+        inDegree[op] = (op % m != 0) + (machinePosition[op] != 0);
+    }
+
+    topologicalOrder.clear();
+    for (int op = 0; op < numberOfOperations; op++) {
+        if (inDegree[op] == 0) {
+            topologicalOrder.push_back(op);
+        }
+    }
+    std::fill(heads.begin(), heads.end(), 0);
+    for (size_t idx = 0; idx < topologicalOrder.size(); idx++) {
+        int op = topologicalOrder[idx];
+        int end = heads[op] + durationOf[op];
+
+        int successors[2] = { -1, -1 };
+        if (op % m != m - 1) {
+            successors[0] = op + 1;
+        }
+        const vector<int>& sequence = sequences[machineOf[op]];
+        if (machinePosition[op] + 1 < (int)sequence.size()) {
+            successors[1] = sequence[machinePosition[op] + 1];
+        }
+        for (int next : successors) {
+            if (next < 0) {
+                continue;
+            }
+            heads[next] = std::max(heads[next], end);
+            if (--inDegree[next] == 0) {
+                topologicalOrder.push_back(next);
+            }
+        }
+    }
+    if ((int)topologicalOrder.size() != numberOfOperations) {
+        return -1;
+    }
+
+    int makespan = 0;
+    for (int idx = numberOfOperations - 1; idx >= 0; idx--) {
+        int op = topologicalOrder[idx];
+        int tail = 0;
+        if (op % m != m - 1) {
+            tail = std::max(tail, durationOf[op + 1] + tails[op + 1]);
+        }
+        const vector<int>& sequence = sequences[machineOf[op]];
+        if (machinePosition[op] + 1 < (int)sequence.size()) {
+            int next = sequence[machinePosition[op] + 1];
+            tail = std::max(tail, durationOf[next] + tails[next]);
+        }
+        tails[op] = tail;
+        makespan = std::max(makespan, heads[op] + durationOf[op] + tail);
+    }
+    return makespan;
+}
+
+vector<int> JspTabuSearch::criticalPath() const {
+    // Walks forward from a source operation on a longest path, prefers machine arcs to keep blocks long.
+    const int m = instance.numberOfMachines;
+    int makespan = 0;
+    for (int op = 0; op < numberOfOperations; op++) {
+        makespan = std::max(makespan, heads[op] + durationOf[op] + tails[op]);
+    }
+
+    vector<int> candidates;
+    for (int op = 0; op < numberOfOperations; op++) {
+        if (heads[op] == 0 && durationOf[op] + tails[op] == makespan) {
+            candidates.push_back(op);
+        }
+    }
+    vector<int> path;
+    int op = candidates[0];
+    while (op >= 0) {
+        path.push_back(op);
+        int next = -1;
+        const vector<int>& sequence = sequences[machineOf[op]];
+        int end = heads[op] + durationOf[op];
+        if (machinePosition[op] + 1 < (int)sequence.size()) {
+            int machineNext = sequence[machinePosition[op] + 1];
+            if (heads[machineNext] == end && durationOf[machineNext] + tails[machineNext] == tails[op]) {
+                next = machineNext;
+            }
+        }
+        if (next < 0 && op % m != m - 1) {
+            int jobNext = op + 1;
+            if (heads[jobNext] == end && durationOf[jobNext] + tails[jobNext] == tails[op]) {
+                next = jobNext;
+            }
+        }
+        op = next;
+    }
+    return path;
+}
+
+vector<JspTabuSearch::Move> JspTabuSearch::neighbourhood(const vector<int>& path) const {
+    // Split the critical path into blocks of consecutive operations on the same machine.
+    vector<std::pair<int, int>> blocks; // [first, last] indices into path
+    int first = 0;
+    for (int i = 1; i <= (int)path.size(); i++) {
+        if (i == (int)path.size() || machineOf[path[i]] != machineOf[path[i - 1]]
+            || machinePosition[path[i]] != machinePosition[path[i - 1]] + 1) {
+            blocks.emplace_back(first, i - 1);
+            first = i;
+        }
+    }
+
+    vector<Move> moves;
+    for (size_t b = 0; b < blocks.size(); b++) {
+        int blockStart = blocks[b].first, blockEnd = blocks[b].second;
+        if (blockStart == blockEnd) {
+            continue;
+        }
+        int machineID = machineOf[path[blockStart]];
+        int firstPos = machinePosition[path[blockStart]];
+        int lastPos = machinePosition[path[blockEnd]];
+
+        // N5: swap the first two operations of the block (not in the first block)
+        // and the last two operations (not in the last block).
+        if (b != 0) {
+            moves.push_back(Move{ machineID, firstPos + 1, firstPos });
+        }
+        if (b + 1 != blocks.size() && (lastPos - 1 != firstPos || b == 0)) {
+            moves.push_back(Move{ machineID, lastPos - 1, lastPos });
+        }
+
+        // N6: move an internal operation to the front or to the back of the block.
+        for (int pos = firstPos + 1; pos < lastPos; pos++) {
+            if (b != 0) {
+                moves.push_back(Move{ machineID, pos, firstPos });
+            }
+            if (b + 1 != blocks.size()) {
+                moves.push_back(Move{ machineID, pos, lastPos });
+            }
+        }
+        // Block ends moved across the whole block.
+        if (lastPos - firstPos >= 2) {
+            moves.push_back(Move{ machineID, lastPos, firstPos });
+            moves.push_back(Move{ machineID, firstPos, lastPos });
+        }
+    }
+    return moves;
+}
+
+void JspTabuSearch::applyMove(const Move& move) {
+    vector<int>& sequence = sequences[move.machineID];
+    if (move.from < move.to) {
+        std::rotate(sequence.begin() + move.from, sequence.begin() + move.from + 1, sequence.begin() + move.to + 1);
+    }
+    else {
+        std::rotate(sequence.begin() + move.to, sequence.begin() + move.from, sequence.begin() + move.from + 1);
+    }
+    int lo = std::min(move.from, move.to), hi = std::max(move.from, move.to);
+    for (int pos = lo; pos <= hi; pos++) {
+        machinePosition[sequence[pos]] = pos;
+    }
+}
+
+bool JspTabuSearch::isTabu(const Move& move, int iteration) const {
+    // The move puts the moved operation before (or after) every operation it jumps over.
+    const vector<int>& sequence = sequences[move.machineID];
+    int op = sequence[move.from];
+    int lo = std::min(move.from, move.to), hi = std::max(move.from, move.to);
+    for (int pos = lo; pos <= hi; pos++) {
+        if (pos == move.from) {
+            continue;
+        }
+        int other = sequence[pos];
+        size_t arc = move.from > move.to ? (size_t)op * numberOfOperations + other : (size_t)other * numberOfOperations + op;
+        if (tabuUntil[arc] > iteration) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void JspTabuSearch::makeTabu(const Move& move, int iteration, int tenure) {
+    // Called before applyMove: forbids restoring the arcs the move reverses.
+    const vector<int>& sequence = sequences[move.machineID];
+    int op = sequence[move.from];
+    int lo = std::min(move.from, move.to), hi = std::max(move.from, move.to);
+    for (int pos = lo; pos <= hi; pos++) {
+        if (pos == move.from) {
+            continue;
+        }
+        int other = sequence[pos];
+        size_t arc = move.from > move.to ? (size_t)other * numberOfOperations + op : (size_t)op * numberOfOperations + other;
+        tabuUntil[arc] = iteration + tenure;
+    }
+}
+
+JspSchedule JspTabuSearch::run(const JspSchedule& initial, const std::atomic<bool>& stop, long long maxIterations,
+                               const std::function<void(const JspSchedule&)>& onImprovement) {
+    loadSchedule(initial);
+    int makespan = evaluate();
+    JspSchedule best = currentSchedule(makespan);
+    vector<vector<int>> bestSequences = sequences;
+
+    const int baseTenure = 8 + instance.numberOfJobs / 2;
+    const int restartAfter = 2000 + 10 * numberOfOperations; // iterations without improvement
+    int sinceImprovement = 0;
+    std::fill(tabuUntil.begin(), tabuUntil.end(), 0);
+
+    for (long long iteration = 1; !stop.load(std::memory_order_relaxed); iteration++) {
+        if (maxIterations > 0 && iteration > maxIterations) {
+            break;
+        }
+        int it = (int)(iteration % (1 << 30));
+
+        vector<Move> moves = neighbourhood(criticalPath());
+        if (moves.empty()) {
+            break; // the critical path is a single job, the schedule is optimal
+        }
+
+        // Evaluate every move exactly, undo it and keep the best admissible one.
+        Move bestMove{ -1, 0, 0 };
+        int bestMoveMakespan = std::numeric_limits<int>::max();
+        Move fallbackMove{ -1, 0, 0 };
+        int fallbackMakespan = std::numeric_limits<int>::max();
+        for (const Move& move : moves) {
+            bool tabu = isTabu(move, it);
+            applyMove(move);
+            int value = evaluate();
+            applyMove(Move{ move.machineID, move.to, move.from });
+            if (value < 0) {
+                continue;
+            }
+            if ((!tabu || value < best.makespan) && value < bestMoveMakespan) {
+                bestMove = move;
+                bestMoveMakespan = value;
+            }
+            if (tabu && value < fallbackMakespan) {
+                fallbackMove = move;
+                fallbackMakespan = value;
+            }
+        }
+        if (bestMove.machineID < 0) {
+            if (fallbackMove.machineID < 0) {
+                break;
+            }
+            bestMove = fallbackMove;
+        }
+
+        int tenure = baseTenure + std::uniform_int_distribution<int>(0, baseTenure)(rng);
+        makeTabu(bestMove, it, tenure);
+        applyMove(bestMove);
+        makespan = evaluate();
+
+        if (makespan < best.makespan) {
+            best = currentSchedule(makespan);
+            bestSequences = sequences;
+            sinceImprovement = 0;
+            if (onImprovement) {
+                onImprovement(best);
+            }
+        }
+        else if (++sinceImprovement >= restartAfter) {
+            // Restart from the best solution perturbed by a few random critical swaps.
+            sequences = bestSequences;
+            for (auto& sequence : sequences) {
+                for (int pos = 0; pos < (int)sequence.size(); pos++) {
+                    machinePosition[sequence[pos]] = pos;
+                }
+            }
+            evaluate();
+            for (int kick = 0; kick < 3; kick++) {
+                vector<Move> kicks = neighbourhood(criticalPath());
+                if (kicks.empty()) {
+                    break;
+                }
+                Move move = kicks[std::uniform_int_distribution<size_t>(0, kicks.size() - 1)(rng)];
+                applyMove(move);
+                if (evaluate() < 0) {
+                    applyMove(Move{ move.machineID, move.to, move.from });
+                    evaluate();
+                }
+            }
+            std::fill(tabuUntil.begin(), tabuUntil.end(), 0);
+            sinceImprovement = 0;
+        }
+    }
+    return best;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "JspInstance.h"
+
+#include <atomic>
+#include <functional>
+#include <random>
+#include <vector>
+
+
+/**
+ Tabu search on the disjunctive graph with the N5 and N6 critical block neighbourhoods.
+ Operations are indexed jobID * numberOfMachines + position of the operation in the job route.
+ */
+class JspTabuSearch {
+    const JSPLIBInstance& instance;
+    int numberOfOperations;
+    std::vector<int> machineOf;  // machine of the operation
+    std::vector<int> durationOf; // duration of the operation
+    std::mt19937 rng;
+
+    // Current solution: processing order of the operations on each machine, heads and tails of the operations.
+    std::vector<std::vector<int>> sequences;
+    std::vector<int> machinePosition; // position of the operation in sequences[machineOf[op]]
+    std::vector<int> heads;
+    std::vector<int> tails;
+    std::vector<int> topologicalOrder;
+
+    std::vector<int> tabuUntil; // tabuUntil[a * numberOfOperations + b] = iteration until 'a before b' is forbidden
+
+    struct Move {
+        int machineID;
+        int from; // position of the moved operation
+        int to;   // its position after the move
+    };
+
+    int evaluate();
+    std::vector<int> criticalPath() const;
+    std::vector<Move> neighbourhood(const std::vector<int>& path) const;
+    void applyMove(const Move& move);
+    bool isTabu(const Move& move, int iteration) const;
+    void makeTabu(const Move& move, int iteration, int tenure);
+    void loadSchedule(const JspSchedule& schedule);
+    JspSchedule currentSchedule(int makespan) const;
+
+public:
+    JspTabuSearch(const JSPLIBInstance& instance, unsigned int seed);
+
+    // Improves the initial schedule until stop is set or maxIterations is reached (<= 0 for no limit).
+    // Every new best schedule is passed to onImprovement.
+    JspSchedule run(const JspSchedule& initial, const std::atomic<bool>& stop, long long maxIterations,
+                    const std::function<void(const JspSchedule&)>& onImprovement);
+};
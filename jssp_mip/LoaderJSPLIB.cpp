@@ -1,53 +1,194 @@
 #pragma once
 
 #include "LoaderJSPLIB.h"
+#include "MappedFile.h"
 
-#include <iostream>
-#include <sstream>
-#include <fstream>
+#include <charconv>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
 
 
 using std::vector;
 using std::string;
+using std::string_view;
+
+
+namespace {
+
+bool isBlank(char ch) {
+    return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n';
+}
+
+string_view trim(string_view text) {
+    while (!text.empty() && isBlank(text.front())) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && isBlank(text.back())) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+// Next line of the buffer starting at pos, pos is moved past its end.
+bool nextLine(string_view text, size_t& pos, string_view& line) {
+    if (pos >= text.size()) {
+        return false;
+    }
+    size_t end = text.find('\n', pos);
+    if (end == string_view::npos) {
+        end = text.size();
+    }
+    line = text.substr(pos, end - pos);
+    pos = end + 1;
+    return true;
+}
+
+// Parses the next integer at or after pos, skipping whitespace.
+bool nextInt(string_view text, size_t& pos, int& value) {
+    while (pos < text.size() && isBlank(text[pos])) {
+        pos++;
+    }
+    auto result = std::from_chars(text.data() + pos, text.data() + text.size(), value);
+    if (result.ec != std::errc()) {
+        return false;
+    }
+    pos = result.ptr - text.data();
+    return true;
+}
+
+// "n m" header line: exactly two integers.
+bool parseHeader(string_view line, int& numberOfJobs, int& numberOfMachines) {
+    size_t pos = 0;
+    if (!nextInt(line, pos, numberOfJobs) || !nextInt(line, pos, numberOfMachines)) {
+        return false;
+    }
+    return trim(line.substr(pos)).empty() && numberOfJobs > 0 && numberOfMachines > 0;
+}
+
+// Name from "instance abz5" or "# instance abz5" lines.
+bool parseInstanceName(string_view line, string& name) {
+    if (!line.empty() && line.front() == '#') {
+        line = trim(line.substr(1));
+    }
+    const string_view keyword = "instance ";
+    if (line.substr(0, keyword.size()) != keyword) {
+        return false;
+    }
+    name = string(trim(line.substr(keyword.size())));
+    return true;
+}
+
+void parseInstances(string_view text, const string& path, const std::function<bool(JSPLIBInstance&&)>& onInstance) {
+    size_t pos = 0;
+    string_view line;
+    string instanceName;
+
+    while (nextLine(text, pos, line)) {
+        line = trim(line);
+        if (line.empty() || line.front() == '+') {
+            continue;
+        }
+        if (parseInstanceName(line, instanceName) || line.front() == '#') {
+            continue;
+        }
+
+        int numberOfJobs, numberOfMachines;
+        if (!parseHeader(line, numberOfJobs, numberOfMachines)) {
+            continue; // description line
+        }
+
+        vector<vector<int>> J(numberOfJobs, vector<int>(numberOfMachines)); // jobs precedence matrix
+        vector<vector<int>> P(numberOfJobs, vector<int>(numberOfMachines)); // job duration on machine
+
+        for (int jobID = 0; jobID < numberOfJobs; jobID++) {
+            for (int i = 0; i < numberOfMachines; i++) {
+                int machineID, jobDuration;
+                if (!nextInt(text, pos, machineID) || !nextInt(text, pos, jobDuration)
+                    || machineID < 0 || machineID >= numberOfMachines) {
+                    throw std::runtime_error("Malformed JSPLIB instance \"" + instanceName + "\" in " + path);
+                }
+                J[jobID][i] = machineID;
+                P[jobID][machineID] = jobDuration;
+            }
+        }
+
+        if (instanceName.empty()) {
+            size_t nameStart = path.find_last_of("/\\");
+            instanceName = path.substr(nameStart == string::npos ? 0 : nameStart + 1);
+        }
+        if (!onInstance(JSPLIBInstance{ instanceName, numberOfJobs, numberOfMachines, std::move(J), std::move(P) })) {
+            return;
+        }
+        instanceName.clear();
+    }
+}
+
+}
 
 
 JSPLIBInstance LoaderJSPLIB::loadInstance(const string& path) {
-    std::ifstream input(path);
-    std::string line;
-
-    getline(input, line);
-    getline(input, line);
-    string datasetName = line;
-    getline(input, line);
-    getline(input, line);
-    getline(input, line);
-
-    std::istringstream is(line);
-    vector<int> parsedLine((std::istream_iterator<int>(is)), (std::istream_iterator<int>()));
-    int numberOfJobs = parsedLine[0];
-    int numberOfMachines = parsedLine[1];
-
-    vector<vector<int>> J(numberOfJobs, vector<int>(numberOfMachines)); // jobs precedence matrix
-    vector<vector<int>> P(numberOfJobs, vector<int>(numberOfMachines)); // job duration on machine
-
-    for (int jobID = 0; jobID < numberOfJobs; jobID++)
-    {
-        getline(input, line);
-
-        std::istringstream is(line);
-        vector<int> parsedLine((std::istream_iterator<int>(is)), (std::istream_iterator<int>()));
-
-        for (int lineIdx = 0; lineIdx < numberOfJobs * 2; lineIdx += 2)
-        {
-            int machineID = parsedLine[lineIdx];
-            int jobDuration = parsedLine[lineIdx + 1];
-
-            J[jobID][lineIdx / 2] = machineID;
-            P[jobID][machineID] = jobDuration;
+    vector<JSPLIBInstance> instances;
+    forEachInstance(path, [&](JSPLIBInstance&& instance) {
+        instances.push_back(std::move(instance));
+        return false;
+    });
+    if (instances.empty()) {
+        throw std::runtime_error("No JSPLIB instance in " + path);
+    }
+    return std::move(instances.front());
+}
+
+JSPLIBInstance LoaderJSPLIB::loadInstance(const string& path, const string& instanceName) {
+    vector<JSPLIBInstance> instances;
+    forEachInstance(path, [&](JSPLIBInstance&& instance) {
+        if (instance.instanceName != instanceName) {
+            return true;
         }
+        instances.push_back(std::move(instance));
+        return false;
+    });
+    if (instances.empty()) {
+        throw std::runtime_error("No JSPLIB instance \"" + instanceName + "\" in " + path);
     }
-    return JSPLIBInstance{datasetName, numberOfJobs, numberOfMachines, J, P };
+    return std::move(instances.front());
 }
 
+JSPLIBInstance LoaderJSPLIB::loadInstanceSpec(const string& instanceSpec) {
+    size_t separator = instanceSpec.rfind('#');
+    if (separator == string::npos) {
+        return loadInstance(instanceSpec);
+    }
+    return loadInstance(instanceSpec.substr(0, separator), instanceSpec.substr(separator + 1));
+}
+
+vector<string> LoaderJSPLIB::listInstanceSpecs(const string& path) {
+    vector<string> names;
+    forEachInstance(path, [&](JSPLIBInstance&& instance) {
+        names.push_back(instance.instanceName);
+        return true;
+    });
+    if (names.size() <= 1) {
+        return vector<string>(names.size(), path);
+    }
+    vector<string> specs;
+    for (const string& name : names) {
+        specs.push_back(path + "#" + name);
+    }
+    return specs;
+}
+
+vector<JSPLIBInstance> LoaderJSPLIB::loadInstances(const string& path) {
+    vector<JSPLIBInstance> instances;
+    forEachInstance(path, [&](JSPLIBInstance&& instance) {
+        instances.push_back(std::move(instance));
+        return true;
+    });
+    return instances;
+}
+
+void LoaderJSPLIB::forEachInstance(const string& path, const std::function<bool(JSPLIBInstance&&)>& onInstance) {
+    MappedFile file(path);
+    parseInstances(file.view(), path, onInstance);
+}
@@ -2,12 +2,33 @@
 
 #include "JspInstance.h"
 
+#include <functional>
 #include <string>
+#include <vector>
 
 
+/**
+ Reader of JSPLIB job shop instances.
+ Accepts both the single instance files ("# instance abz5" header comments) and the multi-instance
+ jobshop1.txt format (instances separated by "+++" lines), the file is memory mapped and parsed in place.
+ */
 class LoaderJSPLIB {
 
 public:
+    // First instance of the file.
     static JSPLIBInstance loadInstance(const std::string& path);
 
+    // Instance with the given name, throws if the file does not contain it.
+    static JSPLIBInstance loadInstance(const std::string& path, const std::string& instanceName);
+
+    static std::vector<JSPLIBInstance> loadInstances(const std::string& path);
+
+    // "path#name" loads the named instance of a multi-instance file, a plain path the first instance.
+    static JSPLIBInstance loadInstanceSpec(const std::string& instanceSpec);
+
+    // One spec per instance of the file: the path itself for single instance files, "path#name" otherwise.
+    static std::vector<std::string> listInstanceSpecs(const std::string& path);
+
+    // Streams the instances of the file in order, stops early when onInstance returns false.
+    static void forEachInstance(const std::string& path, const std::function<bool(JSPLIBInstance&&)>& onInstance);
 };
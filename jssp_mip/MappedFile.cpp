@@ -0,0 +1,97 @@
+#pragma once
+
+#include "MappedFile.h"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path) {
+    fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                             FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        fileHandle = nullptr;
+        throw std::runtime_error("File not opened. File path: " + path);
+    }
+
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(fileHandle, &fileSize);
+    mappedSize = (size_t)fileSize.QuadPart;
+    if (mappedSize == 0) {
+        return; // empty files cannot be mapped
+    }
+
+    mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappingHandle != nullptr) {
+        mappedData = (const char*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+    }
+    if (mappedData == nullptr) {
+        this->~MappedFile();
+        throw std::runtime_error("File not mapped. File path: " + path);
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (mappedData != nullptr) {
+        UnmapViewOfFile(mappedData);
+        mappedData = nullptr;
+    }
+    if (mappingHandle != nullptr) {
+        CloseHandle(mappingHandle);
+        mappingHandle = nullptr;
+    }
+    if (fileHandle != nullptr) {
+        CloseHandle(fileHandle);
+        fileHandle = nullptr;
+    }
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path) {
+    fileDescriptor = open(path.c_str(), O_RDONLY);
+    if (fileDescriptor < 0) {
+        throw std::runtime_error("File not opened. File path: " + path);
+    }
+
+    struct stat fileStat;
+    fstat(fileDescriptor, &fileStat);
+    mappedSize = (size_t)fileStat.st_size;
+    if (mappedSize == 0) {
+        return; // empty files cannot be mapped
+    }
+
+    void* mapping = mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    if (mapping == MAP_FAILED) {
+        close(fileDescriptor);
+        fileDescriptor = -1;
+        throw std::runtime_error("File not mapped. File path: " + path);
+    }
+    madvise(mapping, mappedSize, MADV_SEQUENTIAL);
+    mappedData = (const char*)mapping;
+}
+
+MappedFile::~MappedFile() {
+    if (mappedData != nullptr) {
+        munmap((void*)mappedData, mappedSize);
+        mappedData = nullptr;
+    }
+    if (fileDescriptor >= 0) {
+        close(fileDescriptor);
+        fileDescriptor = -1;
+    }
+}
+
+#endif
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "ModelBuilder.h"
+
+#include <string>
+#include <utility>
+
+
+ModelBuilder::ModelBuilder(GRBModel& model, bool withNames) : model(model), withNames(withNames) {
+}
+
+int ModelBuilder::queueVar(double lb, double ub, double obj, char type) {
+    if (withNames) {
+        varNames.push_back("C" + std::to_string(numberOfVars));
+    }
+    return pushVar(lb, ub, obj, type);
+}
+
+int ModelBuilder::pushVar(double lb, double ub, double obj, char type) {
+    numberOfVars++;
+    lowerBounds.push_back(lb);
+    upperBounds.push_back(ub);
+    objectives.push_back(obj);
+    types.push_back(type);
+    return (int)types.size() - 1;
+}
+
+GRBVar* ModelBuilder::addQueuedVars() {
+    GRBVar* vars = model.addVars(lowerBounds.data(), upperBounds.data(), objectives.data(), types.data(),
+                                 withNames ? varNames.data() : nullptr, (int)types.size());
+    lowerBounds.clear();
+    upperBounds.clear();
+    objectives.clear();
+    types.clear();
+    varNames.clear();
+    return vars;
+}
+
+void ModelBuilder::queueConstr(GRBLinExpr&& lhs, char sense, double rhs) {
+    if (withNames) {
+        constrNames.push_back("R" + std::to_string(numberOfConstrs));
+    }
+    pushConstr(std::move(lhs), sense, rhs);
+}
+
+void ModelBuilder::pushConstr(GRBLinExpr&& lhs, char sense, double rhs) {
+    numberOfConstrs++;
+    lhsExprs.push_back(std::move(lhs));
+    senses.push_back(sense);
+    rhsValues.push_back(rhs);
+    if (lhsExprs.size() >= constrFlushSize) {
+        addQueuedConstrs();
+    }
+}
+
+void ModelBuilder::addQueuedConstrs() {
+    if (lhsExprs.empty()) {
+        return;
+    }
+    GRBConstr* constrs = model.addConstrs(lhsExprs.data(), senses.data(), rhsValues.data(),
+                                          withNames ? constrNames.data() : nullptr, (int)lhsExprs.size());
+    delete[] constrs;
+    lhsExprs.clear();
+    senses.clear();
+    rhsValues.clear();
+    constrNames.clear();
+}
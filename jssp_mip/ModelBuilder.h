@@ -0,0 +1,78 @@
+#pragma once
+
+#include "gurobi_c++.h"
+
+#include <string>
+#include <vector>
+
+
+// Build with MIP_DEBUG_NAMES defined to name every variable and constraint (readable model.write / IIS files).
+#ifdef MIP_DEBUG_NAMES
+constexpr bool modelNamesDefault = true;
+#else
+constexpr bool modelNamesDefault = false;
+#endif
+
+
+/**
+ Batches variables and constraints of a model and adds them with array based addVars / addConstrs calls.
+ Names are passed as callables and evaluated only when names are enabled.
+ */
+class ModelBuilder {
+    GRBModel& model;
+    bool withNames;
+
+    std::vector<double> lowerBounds;
+    std::vector<double> upperBounds;
+    std::vector<double> objectives;
+    std::vector<char> types;
+    std::vector<std::string> varNames;
+
+    std::vector<GRBLinExpr> lhsExprs;
+    std::vector<char> senses;
+    std::vector<double> rhsValues;
+    std::vector<std::string> constrNames;
+
+    // Running counts over all batches, unnamed columns and rows are named C<index> / R<index>
+    // so that the name arrays stay as long as the queued ones.
+    int numberOfVars = 0;
+    int numberOfConstrs = 0;
+
+    static constexpr size_t constrFlushSize = 1 << 16; // queued rows are flushed in chunks to bound memory
+
+    int pushVar(double lb, double ub, double obj, char type);
+    void pushConstr(GRBLinExpr&& lhs, char sense, double rhs);
+
+public:
+    explicit ModelBuilder(GRBModel& model, bool withNames = modelNamesDefault);
+
+    bool namesEnabled() const { return withNames; }
+
+    // Queues a variable, returns its index in the array returned by the next addQueuedVars().
+    int queueVar(double lb, double ub, double obj, char type);
+
+    template <typename NameFn>
+    int queueVar(double lb, double ub, double obj, char type, NameFn&& name) {
+        if (withNames) {
+            varNames.push_back(name());
+        }
+        return pushVar(lb, ub, obj, type);
+    }
+
+    // Adds all queued variables in one call, the returned array is owned by the caller.
+    GRBVar* addQueuedVars();
+
+    // Queues the row 'lhs sense rhs', lhs should not hold a constant.
+    void queueConstr(GRBLinExpr&& lhs, char sense, double rhs);
+
+    template <typename NameFn>
+    void queueConstr(GRBLinExpr&& lhs, char sense, double rhs, NameFn&& name) {
+        if (withNames) {
+            constrNames.push_back(name());
+        }
+        pushConstr(std::move(lhs), sense, rhs);
+    }
+
+    // Adds all queued constraints, called automatically for large batches.
+    void addQueuedConstrs();
+};
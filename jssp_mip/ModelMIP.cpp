@@ -0,0 +1,29 @@
+#pragma once
+
+#include "ModelMIP.h"
+
+#include "gurobi_c++.h"
+
+
+ModelMIP::~ModelMIP() {
+    delete ownedEnv;
+}
+
+GRBEnv& ModelMIP::getEnv() {
+    if (env == nullptr) {
+        ownedEnv = new GRBEnv();
+        env = ownedEnv;
+    }
+    return *env;
+}
+
+void ModelMIP::recordResult(GRBModel& model) {
+    result.status = model.get(GRB_IntAttr_Status);
+    result.solutionCount = model.get(GRB_IntAttr_SolCount);
+    result.runtime = model.get(GRB_DoubleAttr_Runtime);
+    if (result.solutionCount > 0) {
+        result.objective = model.get(GRB_DoubleAttr_ObjVal);
+        result.bound = model.get(GRB_DoubleAttr_ObjBound);
+        result.gap = model.get(GRB_DoubleAttr_MIPGap);
+    }
+}
@@ -1,9 +1,45 @@
 #pragma once
 
+#include <string>
+
+
+class GRBEnv;
+class GRBModel;
+
+struct SolveResult {
+    /// <summary>
+    /// Outcome of the last solveInstance call.
+    /// </summary>
+    std::string instancePath;
+    int status = 0;        // Gurobi status code, 0 if no model was solved
+    int solutionCount = 0;
+    double objective = 0;
+    double bound = 0;
+    double gap = 0;
+    double runtime = 0;    // seconds in optimize()
+};
+
 class ModelMIP {
+private:
+    GRBEnv* ownedEnv = nullptr;
+
+protected:
+    GRBEnv* env = nullptr; // environment shared by the models of one worker, not owned
+    int threads = 0;       // Gurobi Threads parameter, 0 = solver default
+    SolveResult result;
+
+    // Environment for the next model, a private one is created when none was set.
+    GRBEnv& getEnv();
+
+    // Stores status, objective, bound and runtime of the optimized model in result.
+    void recordResult(GRBModel& model);
 
 public:
-    virtual void solveInstance(const char* instancePath, float timeLimit) = 0;
-};
+    virtual ~ModelMIP();
 
+    virtual void solveInstance(const char* instancePath, float timeLimit) = 0;
 
+    void setEnv(GRBEnv* env) { this->env = env; }
+    void setThreads(int threads) { this->threads = threads; }
+    const SolveResult& getResult() const { return result; }
+};
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "SolomonReader.h"
+#include "MappedFile.h"
+#include "DistanceMatrix.h"
+
+#include <charconv>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+using std::string;
+using std::string_view;
+using std::vector;
+
+
+namespace {
+
+bool isBlank(char ch) {
+    return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n';
+}
+
+// Next line of the buffer starting at pos, pos is moved past its end.
+bool nextLine(string_view text, size_t& pos, string_view& line) {
+    if (pos >= text.size()) {
+        return false;
+    }
+    size_t end = text.find('\n', pos);
+    if (end == string_view::npos) {
+        end = text.size();
+    }
+    line = text.substr(pos, end - pos);
+    pos = end + 1;
+    return true;
+}
+
+// All numbers of the line, false if it holds anything else.
+bool parseNumbers(string_view line, vector<double>& numbers) {
+    numbers.clear();
+    size_t pos = 0;
+    while (true) {
+        while (pos < line.size() && isBlank(line[pos])) {
+            pos++;
+        }
+        if (pos == line.size()) {
+            return true;
+        }
+        double value;
+        auto result = std::from_chars(line.data() + pos, line.data() + line.size(), value);
+        if (result.ec != std::errc()) {
+            return false;
+        }
+        numbers.push_back(value);
+        pos = result.ptr - line.data();
+    }
+}
+
+}
+
+
+VrptwInstance SolomonReader::loadInstance(const string& path) {
+    MappedFile file(path);
+    const string_view text = file.view();
+
+    auto malformed = [&](const string& reason) {
+        return std::runtime_error("Malformed Solomon instance (" + reason + "). File path: " + path);
+    };
+
+    int fleetSize = -1, capacity = -1;
+    vector<float> x, y;
+    vector<int> demands, serviceTimes;
+    vector<pair<int, int>> timeWindows;
+
+    // Numeric rows: the first one with two numbers is the vehicle row, the ones with seven numbers are nodes.
+    size_t pos = 0;
+    string_view line;
+    vector<double> numbers;
+    while (nextLine(text, pos, line)) {
+        if (!parseNumbers(line, numbers) || numbers.empty()) {
+            continue; // name, section and column header lines
+        }
+        if (numbers.size() == 2 && fleetSize < 0) {
+            fleetSize = (int)numbers[0];
+            capacity = (int)numbers[1];
+        }
+        else if (numbers.size() == 7 && fleetSize >= 0) {
+            if ((int)numbers[0] != (int)x.size()) {
+                throw malformed("customer " + std::to_string((int)numbers[0]) + " out of order");
+            }
+            x.push_back((float)numbers[1]);
+            y.push_back((float)numbers[2]);
+            demands.push_back((int)std::lround(numbers[3]));
+            timeWindows.emplace_back((int)std::lround(numbers[4]), (int)std::lround(numbers[5]));
+            serviceTimes.push_back((int)std::lround(numbers[6]));
+        }
+        else {
+            throw malformed("unexpected row \"" + string(line) + "\"");
+        }
+    }
+    if (fleetSize < 0 || x.size() < 2) {
+        throw malformed("missing vehicle or customer section");
+    }
+
+    const int N = (int)x.size();
+    DistanceMatrix distanceMatrix = DistanceMatrix::euclidean(x, y, DistanceRounding::Nearest);
+    demands[0] = 0;
+    serviceTimes[0] = 0;
+
+    return { N, capacity, fleetSize, std::move(distanceMatrix), std::move(demands), std::move(timeWindows), std::move(serviceTimes) };
+}
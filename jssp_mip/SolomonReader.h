@@ -0,0 +1,20 @@
+#pragma once
+
+#include "VrptwInstance.h"
+
+#include <string>
+
+
+/**
+ Reader of the plain-text Solomon (1987) and Gehring-Homberger (1999) VRPTW instances:
+ name line, VEHICLE section (NUMBER CAPACITY), CUSTOMER section with one row per node
+ (CUST NO., XCOORD., YCOORD., DEMAND, READY TIME, DUE DATE, SERVICE TIME), node 0 is the depot.
+ The file is memory mapped and parsed in one pass.
+ */
+class SolomonReader {
+
+public:
+    // Distances are Euclidean rounded to the closest int like the VRP-REP instances,
+    // the depot row gives the depot time window.
+    static VrptwInstance loadInstance(const std::string& path);
+};
@@ -1,171 +1,223 @@
 #pragma once
 
 # include "VrpRepXmlReader.h"
+# include "MappedFile.h"
+
+# include <charconv>
 # include <iostream>
-# include <cstring>
+# include <stdexcept>
+# include <string>
+# include <string_view>
+# include <vector>
 
-// todo: TinyXml bug:  Child(char*, int) doesn't work, only Child(int)
 
-VrpRepXmlReader::VrpRepXmlReader(const char *filePath) : xmlFile(filePath), xmlFileHandle(&xmlFile) {
-    if (xmlFile.LoadFile() == false) {
-        throw std::exception("XML file not loaded. File path: " + *filePath);
-    }
+using std::string;
+using std::string_view;
+using std::vector;
 
-    getDatasetName();
-    std::cout << "Dataset \"" << datasetName << "\" loaded." << std::endl;
-}
 
-void VrpRepXmlReader::getDatasetName() {
-    TiXmlElement *datasetElem = xmlFileHandle
-            .FirstChild("instance")
-            .FirstChild("info")
-            .FirstChild("dataset").ToElement();
+namespace {
 
-    if (datasetElem) {
-        datasetName = datasetElem->FirstChild()->Value();
-    }
+bool isBlank(char ch) {
+    return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n';
 }
 
-int VrpRepXmlReader::getNumberOfNodes() {
-    TiXmlElement *node = xmlFileHandle
-            .FirstChild("instance")
-            .ChildElement(1)
-            .FirstChild("nodes")
-            .FirstChild().ToElement();
-
-    int numberOfNodes = 0;
-    for (; node; node = node->NextSiblingElement()) {
-        numberOfNodes++;
+string_view trim(string_view text) {
+    while (!text.empty() && isBlank(text.front())) {
+        text.remove_prefix(1);
     }
-
-    return numberOfNodes;
+    while (!text.empty() && isBlank(text.back())) {
+        text.remove_suffix(1);
+    }
+    return text;
 }
 
-// todo: not using the read node type ( node 0 = depot, ...)
-std::vector<std::pair<float, float>> VrpRepXmlReader::getNodesCoordinates(int numberOfNodes) {
-    std::vector<std::pair<float, float>> nodesCoordinates;
-    nodesCoordinates.reserve(numberOfNodes);
-
-    TiXmlElement *node = xmlFileHandle
-            .FirstChild("instance")
-            .ChildElement(1)
-            .FirstChild("nodes")
-            .FirstChild().ToElement();
-
-    char *p;
-    int ID, nodeType;
-    float cx, cy;
-    for (node; node; node = node->NextSiblingElement()) {
-        ID = std::strtol(node->FirstAttribute()->Value(), &p, 10);
-        nodeType = std::strtol(node->LastAttribute()->Value(), &p, 10);
-        cx = std::strtof(node->FirstChild()->FirstChild()->Value(), &p);
-        cy = std::strtof(node->LastChild()->FirstChild()->Value(), &p);
-        nodesCoordinates.emplace_back(cx, cy);
+// Value of name="..." in the attribute text of a start tag, empty if absent.
+string_view attribute(string_view attributes, string_view name) {
+    size_t pos = 0;
+    while ((pos = attributes.find(name, pos)) != string_view::npos) {
+        size_t end = pos + name.size();
+        bool startsWord = pos == 0 || isBlank(attributes[pos - 1]);
+        while (end < attributes.size() && isBlank(attributes[end])) {
+            end++;
+        }
+        if (startsWord && end < attributes.size() && attributes[end] == '=') {
+            size_t quote = attributes.find_first_of("\"'", end);
+            if (quote == string_view::npos) {break;}
+            size_t close = attributes.find(attributes[quote], quote + 1);
+            if (close == string_view::npos) {break;}
+            return attributes.substr(quote + 1, close - quote - 1);
+        }
+        pos = end;
     }
-
-    return nodesCoordinates;
+    return {};
 }
 
-int VrpRepXmlReader::getFleetSize() {
-
-    const char *fleetSizeSpecification = xmlFileHandle
-            .FirstChild("instance")
-            .Child(2) // <fleet>
-            .FirstChild("vehicle_profile").ToElement()->Attribute("number");
+float toFloat(string_view text) {
+    text = trim(text);
+    float value = 0;
+    std::from_chars(text.data(), text.data() + text.size(), value);
+    return value;
+}
 
-    char *p;
-    return std::strtol(fleetSizeSpecification, &p, 10);
+int toInt(string_view text) {
+    text = trim(text);
+    int value = -1;
+    std::from_chars(text.data(), text.data() + text.size(), value);
+    return value;
 }
 
-std::vector<std::pair<float, float>> VrpRepXmlReader::getTimeWindows(int numberOfNodes) {
-    std::vector<std::pair<float, float>> timeWindows;
-    timeWindows.reserve(numberOfNodes);
-    timeWindows.emplace_back(-1, -1);// depot doesn't have time window, invalid for depot
-    TiXmlElement *request = xmlFileHandle
-            .FirstChild("instance")
-            .Child(3)
-            .FirstChild("request").ToElement();
-
-    char *p;
-    int ID;
-    float start, end;
-    for (request; request; request = request->NextSiblingElement()) {
-        ID = std::strtol(request->FirstAttribute()->Value(), &p, 10);
-
-        TiXmlElement *twElem = request->FirstChildElement();
-        TiXmlNode *startNode = twElem->FirstChildElement()->FirstChild();
-        TiXmlNode *endNode = twElem->FirstChildElement()->NextSiblingElement()->FirstChild();
-
-        start = std::strtof(startNode->Value(), &p);
-        end = std::strtof(endNode->Value(), &p);
-        timeWindows.emplace_back(start, end);
+// Text with the predefined XML entities replaced.
+string decodeText(string_view text) {
+    static const std::pair<string_view, char> entities[] = {
+        { "&lt;", '<' }, { "&gt;", '>' }, { "&amp;", '&' }, { "&quot;", '"' }, { "&apos;", '\'' }
+    };
+    string decoded;
+    for (size_t pos = 0; pos < text.size(); ++pos) {
+        bool replaced = false;
+        if (text[pos] == '&') {
+            for (const auto& entity : entities) {
+                if (text.substr(pos, entity.first.size()) == entity.first) {
+                    decoded += entity.second;
+                    pos += entity.first.size() - 1;
+                    replaced = true;
+                    break;
+                }
+            }
+        }
+        if (!replaced) {decoded += text[pos];}
     }
-
-    return timeWindows;
+    return decoded;
 }
 
-std::vector<float> VrpRepXmlReader::getServiceTimes(int numberOfNodes) {
-    std::vector<float> serviceTimes;
-    serviceTimes.reserve(numberOfNodes);
-    serviceTimes.push_back(-1); // invalid for depot.
-
-    TiXmlElement *request = xmlFileHandle
-            .FirstChild("instance")
-            .Child(3)
-            .FirstChild("request").ToElement();
+template <typename T>
+T& growTo(vector<T>& values, int index, const T& fill) {
+    if ((int)values.size() <= index) {
+        values.resize(index + 1, fill);
+    }
+    return values[index];
+}
 
-    char *p;
-    int ID;
-    float service_time;
-    for (request; request; request = request->NextSiblingElement()) {
+}
 
-        // todo: really tinyxml doesnt work by tag names? only indices?
-        TiXmlNode *service_timeNode
-                = request->FirstChildElement()->NextSiblingElement()->NextSiblingElement()->FirstChild();
 
-        service_time = std::strtof(service_timeNode->Value(), &p);
-        serviceTimes.push_back(service_time);
-    }
+VrpRepXmlReader::VrpRepXmlReader(const char *filePath) {
+    MappedFile file(filePath);
+    parse(file.view(), filePath);
 
-    return serviceTimes;
+    std::cout << "Dataset \"" << datasetName << "\" loaded." << std::endl;
 }
 
-std::vector<float> VrpRepXmlReader::getNodeDemands(int numberOfNodes) {
-    std::vector<float> demands;
-    demands.reserve(numberOfNodes);
-    demands.push_back(-1); // invalid for depot.
-
-    TiXmlElement *request = xmlFileHandle
-            .FirstChild("instance")
-            .Child(3) // <requests>
-            .FirstChild("request").ToElement();
-
-    char *p;
-    int ID;
-    float demand;
-    for (request; request; request = request->NextSiblingElement()) {
-        // <tw>, <quantity>, <service_time>
-        // <quantity>
-        //------- TODO ------------
-        TiXmlNode *service_timeNode
-                = request->FirstChildElement()->NextSiblingElement()->FirstChild();
-              //= request->FirstChildElement()->FirstChild();
-
-        demand = std::strtof(service_timeNode->Value(), &p);
-        demands.push_back(demand);
+void VrpRepXmlReader::parse(string_view text, const string& path) {
+    // Open elements, innermost last. Views into the mapped buffer.
+    vector<string_view> openElements;
+    int node = -1, request = -1;
+
+    auto parent = [&](size_t up) { return openElements.size() > up ? openElements[openElements.size() - 1 - up] : string_view(); };
+    auto malformed = [&]() { return std::runtime_error("Malformed VRP-REP XML file. File path: " + path); };
+
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t open = text.find('<', pos);
+        if (open == string_view::npos) {
+            break;
+        }
+
+        // ------ Character data of the innermost element. ---------------
+        string_view content = trim(text.substr(pos, open - pos));
+        if (!content.empty() && !openElements.empty()) {
+            string_view element = openElements.back();
+            if (element == "cx" && node >= 0) {
+                growTo(nodesCoordinates, node, { 0.f, 0.f }).first = toFloat(content);
+            }
+            else if (element == "cy" && node >= 0) {
+                growTo(nodesCoordinates, node, { 0.f, 0.f }).second = toFloat(content);
+            }
+            else if (element == "start" && parent(1) == "tw" && request >= 0) {
+                growTo(timeWindows, request, { -1.f, -1.f }).first = toFloat(content);
+            }
+            else if (element == "end" && parent(1) == "tw" && request >= 0) {
+                growTo(timeWindows, request, { -1.f, -1.f }).second = toFloat(content);
+            }
+            else if (element == "quantity" && request >= 0) {
+                growTo(demands, request, -1.f) = toFloat(content);
+            }
+            else if (element == "service_time" && request >= 0) {
+                growTo(serviceTimes, request, -1.f) = toFloat(content);
+            }
+            else if (element == "capacity" && parent(1) == "vehicle_profile") {
+                vehicleCapacity = toFloat(content);
+            }
+            else if (element == "max_travel_time" && parent(1) == "vehicle_profile") {
+                maxTravelTime = toFloat(content);
+            }
+            else if (element == "dataset" && parent(1) == "info") {
+                datasetName = decodeText(content);
+            }
+        }
+
+        // ------ Markup: declarations, comments, end and start tags. ---------------
+        if (text.substr(open, 4) == "<!--") {
+            size_t close = text.find("-->", open);
+            if (close == string_view::npos) {throw malformed();}
+            pos = close + 3;
+            continue;
+        }
+        size_t close = text.find('>', open);
+        if (close == string_view::npos) {
+            throw malformed();
+        }
+        pos = close + 1;
+        string_view tag = text.substr(open + 1, close - open - 1);
+        if (tag.empty() || tag.front() == '?' || tag.front() == '!') {
+            continue;
+        }
+
+        if (tag.front() == '/') {
+            string_view name = trim(tag.substr(1));
+            if (openElements.empty() || openElements.back() != name) {throw malformed();}
+            if (name == "node") {node = -1;}
+            if (name == "request") {request = -1;}
+            openElements.pop_back();
+            continue;
+        }
+
+        bool selfClosing = tag.back() == '/';
+        if (selfClosing) {
+            tag.remove_suffix(1);
+        }
+        size_t nameEnd = 0;
+        while (nameEnd < tag.size() && !isBlank(tag[nameEnd])) {
+            nameEnd++;
+        }
+        string_view name = tag.substr(0, nameEnd);
+        string_view attributes = tag.substr(nameEnd);
+
+        if (name == "node" && parent(0) == "nodes") {
+            node = toInt(attribute(attributes, "id"));
+            if (node < 0) {throw malformed();}
+            growTo(nodesCoordinates, node, { 0.f, 0.f });
+        }
+        else if (name == "request" && parent(0) == "requests") {
+            request = toInt(attribute(attributes, "node"));
+            if (request < 0) {throw malformed();}
+        }
+        else if (name == "vehicle_profile") {
+            fleetSize = toInt(attribute(attributes, "number"));
+        }
+
+        if (!selfClosing) {
+            openElements.push_back(name);
+        }
     }
 
-    return demands;
-}
-
-float VrpRepXmlReader::getVehicleCapacity() {
-    const char *vehicleCapacity = xmlFileHandle
-            .FirstChild("instance")
-            .Child(2) // <fleet>
-            .FirstChild("vehicle_profile")
-            .Child(2) // <capacity>
-            .ToElement()->FirstChild()->Value();
+    const int N = (int)nodesCoordinates.size();
+    if (!openElements.empty() || N == 0 || (int)timeWindows.size() > N || (int)serviceTimes.size() > N || (int)demands.size() > N) {
+        throw malformed();
+    }
 
-    char *p;
-    return std::strtof(vehicleCapacity, &p);
+    // Nodes without a request (the depot) keep the invalid -1 entries.
+    timeWindows.resize(N, { -1.f, -1.f });
+    serviceTimes.resize(N, -1.f);
+    demands.resize(N, -1.f);
 }
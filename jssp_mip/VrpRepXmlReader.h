@@ -1,37 +1,47 @@
 #pragma once
 
-#include "tinyxml.h"
-
 #include <vector>
 #include <string>
+#include <string_view>
 
 
 /**
  Class facilitating of reading the .xml datasets in "VRP-REP" format.
+ The memory-mapped file is parsed once by a streaming tag reader, elements are matched by name:
+ instance/network/nodes/node (cx, cy), instance/fleet/vehicle_profile (number, capacity, max_travel_time)
+ and instance/requests/request (tw start / end, quantity, service_time), requests are matched to nodes by their node attribute.
  */
 class VrpRepXmlReader {
-    TiXmlDocument xmlFile;
-    TiXmlHandle xmlFileHandle;
+    std::vector<std::pair<float, float>> nodesCoordinates;
+    std::vector<std::pair<float, float>> timeWindows;
+    std::vector<float> serviceTimes;
+    std::vector<float> demands;
+    int fleetSize = 0;
+    float vehicleCapacity = 0;
+    float maxTravelTime = 0;
+
+    void parse(std::string_view text, const std::string& path);
 
 public:
     std::string datasetName;
 
     VrpRepXmlReader(const char *filePath);
 
-    void getDatasetName();
+    int getNumberOfNodes() const { return (int)nodesCoordinates.size(); }
 
-    int getNumberOfNodes();
+    int getFleetSize() const { return fleetSize; }
 
-    int getFleetSize();
+    float getVehicleCapacity() const { return vehicleCapacity; }
 
-    std::vector<std::pair<float, float>> getNodesCoordinates(int numberOfNodes);
+    // Route duration limit of the vehicle profile, 0 if the file has none.
+    float getMaxTravelTime() const { return maxTravelTime; }
 
-    std::vector<std::pair<float, float>> getTimeWindows(int numberOfNodes);
+    // Indexed by node id. The depot has no request, its time window, service time and demand are -1.
+    const std::vector<std::pair<float, float>>& getNodesCoordinates() const { return nodesCoordinates; }
 
-    std::vector<float> getServiceTimes(int numberOfNodes);
+    const std::vector<std::pair<float, float>>& getTimeWindows() const { return timeWindows; }
 
-    std::vector<float> getNodeDemands(int numberOfNodes);
+    const std::vector<float>& getServiceTimes() const { return serviceTimes; }
 
-    float getVehicleCapacity();
+    const std::vector<float>& getNodeDemands() const { return demands; }
 };
-
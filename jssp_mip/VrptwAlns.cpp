@@ -0,0 +1,604 @@
+#pragma once
+
+#include "VrptwAlns.h"
+#include "VrptwHeuristics.h"
+#include "VrptwLocalSearch.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+using std::vector;
+
+namespace {
+
+constexpr double costTolerance = 1e-9;
+constexpr double infinity = std::numeric_limits<double>::infinity();
+
+// Scores of an iteration: new best, better than current, accepted although worse.
+constexpr double scoreBest = 33, scoreBetter = 9, scoreAccepted = 13;
+
+constexpr int numberOfRemovals = 3;   // random, worst, Shaw
+constexpr int numberOfInsertions = 3; // greedy, regret-2, regret-3
+
+VrptwLocalSearchParams localSearchParams(unsigned int seed) {
+    VrptwLocalSearchParams params;
+    params.seed = seed;
+    return params;
+}
+
+int rouletteWheel(const double* weights, int size, std::mt19937& rng) {
+    double total = std::accumulate(weights, weights + size, 0.0);
+    double pick = std::uniform_real_distribution<double>(0, total)(rng);
+    for (int k = 0; k < size; ++k) {
+        pick -= weights[k];
+        if (pick <= 0) {
+            return k;
+        }
+    }
+    return size - 1;
+}
+
+}
+
+
+/**
+ One search thread: current solution with cached earliest / latest service starts per route.
+ */
+class VrptwAlns::Search {
+    struct State {
+        vector<vector<int>> routes;          // customers only
+        vector<int> unassigned;
+        vector<int> routeLoad;
+        vector<int> routeDistance;
+        vector<vector<long long>> earliest;  // over 0, customers..., 0
+        vector<vector<long long>> latest;    // latest start keeping the rest of the route feasible
+    };
+
+    const VrptwInstance& instance;
+    const VrptwAlnsParams& params;
+    VrptwAlns& alns;
+    std::mt19937 rng;
+    VrptwLocalSearch localSearch;
+    const int N;
+    double unassignedPenalty;
+    int maxDistance = 1;
+    int horizon = 1;
+
+    State state;
+
+    int node(int r, int k) const {
+        return (k == 0 || k == (int)state.routes[r].size() + 1) ? 0 : state.routes[r][k - 1];
+    }
+
+    double objective() const {
+        return std::accumulate(state.routeDistance.begin(), state.routeDistance.end(), 0.0)
+             + unassignedPenalty * state.unassigned.size();
+    }
+
+    void updateRoute(int r);
+    void addRoute(vector<int>&& customers);
+    void load(const VrptwSolution& solution);
+    VrptwSolution solution() const;
+
+    // Removal operators, q customers move to unassigned.
+    void removeCustomers(const vector<char>& removed);
+    void randomRemoval(int q);
+    void worstRemoval(int q);
+    void shawRemoval(int q);
+    void removal(int op, int q);
+
+    // Cheapest feasible position of customer in route r (insert before node k), false if none.
+    bool cheapestPosition(int customer, int r, double& delta, int& position) const;
+    double newRouteDelta(int customer) const;
+
+    // Regret-k insertion of the unassigned customers, k = 1 is greedy.
+    void insertion(int regret);
+
+public:
+    Search(const VrptwInstance& instance, const VrptwAlnsParams& params, VrptwAlns& alns, unsigned int seed);
+
+    void run(const VrptwSolution& initial, const std::atomic<bool>& stop, std::chrono::steady_clock::time_point deadline);
+};
+
+
+VrptwAlns::Search::Search(const VrptwInstance& instance, const VrptwAlnsParams& params, VrptwAlns& alns, unsigned int seed)
+    : instance(instance), params(params), alns(alns), rng(seed), localSearch(instance, localSearchParams(seed)),
+      N(instance.numberOfNodes) {
+
+    maxDistance = std::max(1, instance.distanceMatrix.maxValue());
+    for (int i = 1; i < N; ++i) {
+        horizon = std::max(horizon, instance.timeWindows[i].second);
+    }
+    // Any feasible insertion is cheaper than leaving the customer out.
+    unassignedPenalty = 2.0 * maxDistance + 1;
+}
+
+void VrptwAlns::Search::updateRoute(int r) {
+    const vector<int>& route = state.routes[r];
+    const int m = (int)route.size();
+    const auto& t = instance.distanceMatrix;
+    const auto& tw = instance.timeWindows;
+    const auto& s = instance.serviceTimes;
+
+    vector<long long>& earliest = state.earliest[r];
+    vector<long long>& latest = state.latest[r];
+    earliest.assign(m + 2, 0);
+    latest.assign(m + 2, 0);
+
+    earliest[0] = tw[0].first;
+    for (int k = 1; k <= m + 1; ++k) {
+        int previous = node(r, k - 1), current = node(r, k);
+        earliest[k] = std::max((long long)tw[current].first, earliest[k - 1] + s[previous] + t[previous][current]);
+    }
+    latest[m + 1] = tw[0].second;
+    for (int k = m; k >= 0; --k) {
+        int current = node(r, k), next = node(r, k + 1);
+        latest[k] = std::min((long long)tw[current].second, latest[k + 1] - s[current] - t[current][next]);
+    }
+
+    state.routeLoad[r] = 0;
+    for (int customer : route) {
+        state.routeLoad[r] += instance.demands[customer];
+    }
+    state.routeDistance[r] = routeCost(instance, route);
+}
+
+void VrptwAlns::Search::addRoute(vector<int>&& customers) {
+    state.routes.push_back(std::move(customers));
+    state.routeLoad.push_back(0);
+    state.routeDistance.push_back(0);
+    state.earliest.emplace_back();
+    state.latest.emplace_back();
+    updateRoute((int)state.routes.size() - 1);
+}
+
+void VrptwAlns::Search::load(const VrptwSolution& solution) {
+    state = State();
+    vector<char> assigned(N, 0);
+
+    // Routes beyond the fleet size are dropped, the largest routes are kept.
+    vector<const VrptwRoute*> routes;
+    for (const VrptwRoute& route : solution.routes) {
+        routes.push_back(&route);
+    }
+    std::stable_sort(routes.begin(), routes.end(), [](const VrptwRoute* a, const VrptwRoute* b) {
+        return a->customers.size() > b->customers.size();
+    });
+    for (const VrptwRoute* route : routes) {
+        if ((int)state.routes.size() >= instance.fleetSize) {break;}
+        for (int customer : route->customers) {
+            assigned[customer] = 1;
+        }
+        addRoute(vector<int>(route->customers));
+    }
+    for (int i = 1; i < N; ++i) {
+        if (!assigned[i]) {state.unassigned.push_back(i);}
+    }
+}
+
+VrptwSolution VrptwAlns::Search::solution() const {
+    VrptwSolution solution;
+    for (size_t r = 0; r < state.routes.size(); ++r) {
+        solution.routes.push_back({ state.routes[r], state.routeDistance[r] });
+        solution.cost += state.routeDistance[r];
+    }
+    return solution;
+}
+
+void VrptwAlns::Search::removeCustomers(const vector<char>& removed) {
+    for (int r = (int)state.routes.size() - 1; r >= 0; --r) {
+        vector<int>& route = state.routes[r];
+        auto end = std::remove_if(route.begin(), route.end(), [&](int customer) { return removed[customer]; });
+        if (end == route.end()) {
+            continue;
+        }
+        route.erase(end, route.end());
+        if (route.empty()) {
+            state.routes.erase(state.routes.begin() + r);
+            state.routeLoad.erase(state.routeLoad.begin() + r);
+            state.routeDistance.erase(state.routeDistance.begin() + r);
+            state.earliest.erase(state.earliest.begin() + r);
+            state.latest.erase(state.latest.begin() + r);
+        }
+        else {
+            updateRoute(r);
+        }
+    }
+    for (int i = 1; i < N; ++i) {
+        if (removed[i]) {state.unassigned.push_back(i);}
+    }
+}
+
+void VrptwAlns::Search::randomRemoval(int q) {
+    vector<int> assigned;
+    for (const vector<int>& route : state.routes) {
+        assigned.insert(assigned.end(), route.begin(), route.end());
+    }
+    std::shuffle(assigned.begin(), assigned.end(), rng);
+
+    vector<char> removed(N, 0);
+    for (int k = 0; k < q && k < (int)assigned.size(); ++k) {
+        removed[assigned[k]] = 1;
+    }
+    removeCustomers(removed);
+}
+
+void VrptwAlns::Search::worstRemoval(int q) {
+    // Customers by the distance saved when they are taken out of their route, largest first.
+    vector<pair<double, int>> savings;
+    for (int r = 0; r < (int)state.routes.size(); ++r) {
+        for (int k = 1; k <= (int)state.routes[r].size(); ++k) {
+            int previous = node(r, k - 1), customer = node(r, k), next = node(r, k + 1);
+            double saving = instance.distanceMatrix[previous][customer] + instance.distanceMatrix[customer][next]
+                          - instance.distanceMatrix[previous][next];
+            savings.push_back({ -saving, customer });
+        }
+    }
+    std::sort(savings.begin(), savings.end());
+
+    vector<char> removed(N, 0);
+    std::uniform_real_distribution<double> uniform(0, 1);
+    for (int k = 0; k < q && !savings.empty(); ++k) {
+        size_t rank = (size_t)(std::pow(uniform(rng), params.randomization) * savings.size());
+        removed[savings[rank].second] = 1;
+        savings.erase(savings.begin() + rank);
+    }
+    removeCustomers(removed);
+}
+
+void VrptwAlns::Search::shawRemoval(int q) {
+    vector<int> assigned;
+    for (const vector<int>& route : state.routes) {
+        assigned.insert(assigned.end(), route.begin(), route.end());
+    }
+    if (assigned.empty()) {
+        return;
+    }
+
+    // Relatedness of Ropke and Pisinger: distance, window start and demand, lower is more related.
+    auto relatedness = [&](int i, int j) {
+        return 9.0 * instance.distanceMatrix[i][j] / maxDistance
+             + 3.0 * std::abs(instance.timeWindows[i].first - instance.timeWindows[j].first) / horizon
+             + 2.0 * std::abs(instance.demands[i] - instance.demands[j]) / std::max(1, instance.vehicleCapacity);
+    };
+
+    vector<char> removed(N, 0);
+    std::uniform_real_distribution<double> uniform(0, 1);
+    size_t seed = std::uniform_int_distribution<size_t>(0, assigned.size() - 1)(rng);
+    vector<int> removedList = { assigned[seed] };
+    removed[assigned[seed]] = 1;
+    assigned.erase(assigned.begin() + seed);
+
+    while ((int)removedList.size() < q && !assigned.empty()) {
+        int reference = removedList[std::uniform_int_distribution<size_t>(0, removedList.size() - 1)(rng)];
+        std::sort(assigned.begin(), assigned.end(), [&](int a, int b) {
+            return relatedness(reference, a) < relatedness(reference, b);
+        });
+        size_t rank = (size_t)(std::pow(uniform(rng), params.randomization) * assigned.size());
+        removedList.push_back(assigned[rank]);
+        removed[assigned[rank]] = 1;
+        assigned.erase(assigned.begin() + rank);
+    }
+    removeCustomers(removed);
+}
+
+void VrptwAlns::Search::removal(int op, int q) {
+    switch (op) {
+    case 0: randomRemoval(q); break;
+    case 1: worstRemoval(q); break;
+    default: shawRemoval(q); break;
+    }
+}
+
+bool VrptwAlns::Search::cheapestPosition(int customer, int r, double& delta, int& position) const {
+    if (state.routeLoad[r] + instance.demands[customer] > instance.vehicleCapacity) {
+        return false;
+    }
+    const auto& t = instance.distanceMatrix;
+    const auto& tw = instance.timeWindows;
+    const auto& s = instance.serviceTimes;
+    const vector<long long>& earliest = state.earliest[r];
+    const vector<long long>& latest = state.latest[r];
+
+    delta = infinity;
+    position = -1;
+    for (int k = 1; k <= (int)state.routes[r].size() + 1; ++k) {
+        int previous = node(r, k - 1), next = node(r, k);
+        long long start = std::max((long long)tw[customer].first, earliest[k - 1] + s[previous] + t[previous][customer]);
+        if (start > tw[customer].second) {
+            continue;
+        }
+        long long startNext = std::max((long long)tw[next].first, start + s[customer] + t[customer][next]);
+        if (startNext > latest[k]) {
+            continue;
+        }
+        double increase = t[previous][customer] + t[customer][next] - t[previous][next];
+        if (increase < delta) {
+            delta = increase;
+            position = k;
+        }
+    }
+    return position >= 0;
+}
+
+double VrptwAlns::Search::newRouteDelta(int customer) const {
+    const auto& t = instance.distanceMatrix;
+    const auto& tw = instance.timeWindows;
+    long long start = std::max((long long)tw[customer].first, (long long)tw[0].first + t[0][customer]);
+    if (start > tw[customer].second || start + instance.serviceTimes[customer] + t[customer][0] > tw[0].second
+        || instance.demands[customer] > instance.vehicleCapacity) {
+        return infinity;
+    }
+    return t[0][customer] + t[customer][0];
+}
+
+void VrptwAlns::Search::insertion(int regret) {
+    vector<int> pending = std::move(state.unassigned);
+    state.unassigned.clear();
+    std::shuffle(pending.begin(), pending.end(), rng);
+
+    const int P = (int)pending.size();
+    vector<vector<double>> delta(P);  // delta[p][r] = cheapest insertion of pending[p] into route r
+    vector<vector<int>> position(P);
+    vector<double> newRoute(P);
+    auto evaluate = [&](int p, int r) {
+        if (!cheapestPosition(pending[p], r, delta[p][r], position[p][r])) {
+            delta[p][r] = infinity;
+        }
+    };
+    for (int p = 0; p < P; ++p) {
+        delta[p].resize(state.routes.size());
+        position[p].resize(state.routes.size());
+        for (int r = 0; r < (int)state.routes.size(); ++r) {
+            evaluate(p, r);
+        }
+        newRoute[p] = newRouteDelta(pending[p]);
+    }
+
+    vector<char> inserted(P, 0);
+    for (int step = 0; step < P; ++step) {
+        const bool canOpenRoute = (int)state.routes.size() < instance.fleetSize;
+
+        int bestPending = -1, bestRoute = -1;
+        double bestRegret = -infinity, bestCost = infinity;
+        for (int p = 0; p < P; ++p) {
+            if (inserted[p]) {continue;}
+
+            // The three cheapest options, route index == routes.size() opens a new route.
+            double cost[3] = { infinity, infinity, infinity };
+            int route = -1;
+            auto consider = [&](double value, int r) {
+                if (value < cost[0]) {
+                    cost[2] = cost[1]; cost[1] = cost[0]; cost[0] = value; route = r;
+                }
+                else if (value < cost[1]) {
+                    cost[2] = cost[1]; cost[1] = value;
+                }
+                else if (value < cost[2]) {
+                    cost[2] = value;
+                }
+            };
+            for (int r = 0; r < (int)state.routes.size(); ++r) {
+                consider(delta[p][r], r);
+            }
+            if (canOpenRoute) {
+                consider(newRoute[p], (int)state.routes.size());
+            }
+            if (cost[0] == infinity) {
+                continue;
+            }
+
+            double regretValue = -cost[0];
+            if (regret > 1) {
+                regretValue = 0;
+                for (int h = 1; h < regret; ++h) {
+                    regretValue += std::min(cost[h], unassignedPenalty) - cost[0];
+                }
+            }
+            if (regretValue > bestRegret + costTolerance
+                || (regretValue > bestRegret - costTolerance && cost[0] < bestCost)) {
+                bestRegret = regretValue;
+                bestCost = cost[0];
+                bestPending = p;
+                bestRoute = route;
+            }
+        }
+        if (bestPending < 0) {
+            break;
+        }
+
+        const int customer = pending[bestPending];
+        inserted[bestPending] = 1;
+        if (bestRoute == (int)state.routes.size()) {
+            addRoute({ customer });
+            for (int p = 0; p < P; ++p) {
+                delta[p].push_back(infinity);
+                position[p].push_back(-1);
+            }
+        }
+        else {
+            vector<int>& route = state.routes[bestRoute];
+            route.insert(route.begin() + (position[bestPending][bestRoute] - 1), customer);
+            updateRoute(bestRoute);
+        }
+        for (int p = 0; p < P; ++p) {
+            if (!inserted[p]) {evaluate(p, bestRoute);}
+        }
+    }
+
+    for (int p = 0; p < P; ++p) {
+        if (!inserted[p]) {state.unassigned.push_back(pending[p]);}
+    }
+}
+
+void VrptwAlns::Search::run(const VrptwSolution& initial, const std::atomic<bool>& stop,
+                            std::chrono::steady_clock::time_point deadline) {
+    load(initial);
+    insertion(2);
+
+    double currentObjective = objective();
+    double bestObjective = currentObjective;
+    if (state.unassigned.empty()) {
+        alns.offerToPool(solution());
+    }
+
+    double temperature = params.startTemperature * currentObjective / std::log(2.0);
+    double removalWeights[numberOfRemovals], insertionWeights[numberOfInsertions];
+    double removalScores[numberOfRemovals] = {}, insertionScores[numberOfInsertions] = {};
+    int removalUses[numberOfRemovals] = {}, insertionUses[numberOfInsertions] = {};
+    std::fill(removalWeights, removalWeights + numberOfRemovals, 1.0);
+    std::fill(insertionWeights, insertionWeights + numberOfInsertions, 1.0);
+
+    const int customers = N - 1;
+    const int minRemoved = std::max(1, (int)(params.minRemovalFraction * customers));
+    const int maxRemoved = std::max(minRemoved, std::min(params.maxRemovedCustomers, (int)(params.maxRemovalFraction * customers)));
+    std::uniform_real_distribution<double> uniform(0, 1);
+
+    long long sinceImprovement = 0;
+    for (long long iteration = 1; params.iterations <= 0 || iteration <= params.iterations; ++iteration) {
+        if (stop || std::chrono::steady_clock::now() >= deadline) {
+            break;
+        }
+
+        State backup = state;
+        int removalOp = rouletteWheel(removalWeights, numberOfRemovals, rng);
+        int insertionOp = rouletteWheel(insertionWeights, numberOfInsertions, rng);
+        int q = std::uniform_int_distribution<int>(minRemoved, maxRemoved)(rng);
+
+        removal(removalOp, q);
+        insertion(insertionOp + 1);
+
+        double newObjective = objective();
+        double score = 0;
+        if (newObjective < bestObjective - costTolerance) {
+            bestObjective = newObjective;
+            currentObjective = newObjective;
+            score = scoreBest;
+            sinceImprovement = 0;
+            if (state.unassigned.empty()) {
+                // New best routes are polished by local search before they are shared.
+                VrptwSolution improved = solution();
+                if (params.localSearch && localSearch.improve(improved)) {
+                    load(improved);
+                    bestObjective = currentObjective = objective();
+                }
+                alns.offerToPool(solution());
+            }
+        }
+        else if (newObjective < currentObjective - costTolerance) {
+            currentObjective = newObjective;
+            score = scoreBetter;
+        }
+        else if (uniform(rng) < std::exp((currentObjective - newObjective) / std::max(temperature, costTolerance))) {
+            currentObjective = newObjective;
+            score = scoreAccepted;
+        }
+        else {
+            state = std::move(backup);
+        }
+        temperature *= params.cooling;
+
+        removalScores[removalOp] += score;
+        removalUses[removalOp]++;
+        insertionScores[insertionOp] += score;
+        insertionUses[insertionOp]++;
+
+        // ------ Adaptive weights. ---------------
+        if (iteration % params.segmentLength == 0) {
+            for (int k = 0; k < numberOfRemovals; ++k) {
+                if (removalUses[k] > 0) {
+                    removalWeights[k] = (1 - params.reactionFactor) * removalWeights[k]
+                                      + params.reactionFactor * std::max(0.1, removalScores[k] / removalUses[k]);
+                }
+                removalScores[k] = 0;
+                removalUses[k] = 0;
+            }
+            for (int k = 0; k < numberOfInsertions; ++k) {
+                if (insertionUses[k] > 0) {
+                    insertionWeights[k] = (1 - params.reactionFactor) * insertionWeights[k]
+                                        + params.reactionFactor * std::max(0.1, insertionScores[k] / insertionUses[k]);
+                }
+                insertionScores[k] = 0;
+                insertionUses[k] = 0;
+            }
+        }
+
+        // ------ Restart from the shared pool when stalled. ---------------
+        if (++sinceImprovement >= params.restartIterations) {
+            VrptwSolution restart;
+            if (alns.sampleFromPool((unsigned int)rng(), restart)) {
+                load(restart);
+                insertion(2);
+                currentObjective = objective();
+            }
+            sinceImprovement = 0;
+        }
+    }
+}
+
+
+VrptwAlns::VrptwAlns(const VrptwInstance& instance, const VrptwAlnsParams& params)
+    : instance(instance), params(params) {
+}
+
+bool VrptwAlns::offerToPool(const VrptwSolution& solution) {
+    std::lock_guard<std::mutex> lock(poolMutex);
+
+    auto position = std::lower_bound(pool.begin(), pool.end(), solution.cost,
+                                     [](const VrptwSolution& a, int cost) { return a.cost < cost; });
+    if (position != pool.end() && position->cost == solution.cost) {
+        return false;
+    }
+    bool newBest = position == pool.begin();
+    pool.insert(position, solution);
+    if ((int)pool.size() > params.poolSize) {
+        pool.pop_back();
+    }
+
+    if (newBest && onImprovement) {
+        onImprovement(solution);
+    }
+    return newBest;
+}
+
+bool VrptwAlns::sampleFromPool(unsigned int random, VrptwSolution& solution) {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    if (pool.empty()) {
+        return false;
+    }
+    solution = pool[random % pool.size()];
+    return true;
+}
+
+VrptwSolution VrptwAlns::run(const VrptwSolution& initial, const std::atomic<bool>& stop,
+                             const std::function<void(const VrptwSolution&)>& onImprovement) {
+    this->onImprovement = onImprovement;
+    pool.clear();
+
+    const VrptwSolution start = initial.routes.empty() ? VrptwHeuristics::solomonInsertion(instance, InsertionParams()) : initial;
+    const auto deadline = std::chrono::steady_clock::now()
+                        + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(params.timeLimit));
+
+    int threads = params.threads > 0 ? params.threads : std::max(1, (int)std::thread::hardware_concurrency());
+    vector<std::thread> workers;
+    for (int k = 0; k < threads; ++k) {
+        workers.emplace_back([&, k]() {
+            Search search(instance, params, *this, params.seed + k);
+            search.run(start, stop, deadline);
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    std::lock_guard<std::mutex> lock(poolMutex);
+    return pool.empty() ? VrptwSolution() : pool.front();
+}
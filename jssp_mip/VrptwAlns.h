@@ -0,0 +1,61 @@
+#pragma once
+
+#include "VrptwInstance.h"
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+
+struct VrptwAlnsParams {
+    /// <summary>
+    /// Parameters of the adaptive large neighbourhood search (Ropke and Pisinger, 2006).
+    /// </summary>
+    int threads = 0;                   // independent searches, 0 = hardware threads
+    long long iterations = 0;          // per search, <= 0 for no limit
+    double timeLimit = 60;             // seconds
+    unsigned int seed = 0;
+    double minRemovalFraction = 0.05;  // customers removed per iteration, as a fraction of all customers
+    double maxRemovalFraction = 0.3;
+    int maxRemovedCustomers = 60;
+    double randomization = 3;          // worst / Shaw removal pick the rank floor(y^p * n), y uniform
+    int segmentLength = 100;           // iterations between weight updates
+    double reactionFactor = 0.1;
+    double startTemperature = 0.05;    // a solution this much worse is accepted with probability 0.5 at the start
+    double cooling = 0.9998;
+    int poolSize = 8;                  // best known solutions shared between the searches
+    int restartIterations = 2000;      // iterations without improvement before restarting from the pool
+    bool localSearch = true;           // relocate / swap / 2-opt* descent on every new best solution
+};
+
+
+/**
+ Adaptive large neighbourhood search for the VRPTW.
+ Removal: random, worst and Shaw. Insertion: greedy, regret-2 and regret-3. Operator weights adapt to their scores,
+ acceptance is simulated annealing. Several searches run in parallel and share a pool of the best solutions,
+ a search that stalls restarts from a pool solution. Routes never exceed the fleet size, customers that fit
+ nowhere stay unassigned with a penalty, only complete solutions enter the pool.
+ */
+class VrptwAlns {
+    class Search;
+
+    const VrptwInstance& instance;
+    VrptwAlnsParams params;
+
+    std::mutex poolMutex;
+    std::vector<VrptwSolution> pool; // ascending cost
+    std::function<void(const VrptwSolution&)> onImprovement;
+
+    // Adds a complete solution to the pool, returns true if it is the new best.
+    bool offerToPool(const VrptwSolution& solution);
+    bool sampleFromPool(unsigned int random, VrptwSolution& solution);
+
+public:
+    VrptwAlns(const VrptwInstance& instance, const VrptwAlnsParams& params);
+
+    // Improves the initial solution (I1 insertion if empty) until stop is set, the time or the iteration limit is reached.
+    // Every new best solution is passed to onImprovement, from the search thread that found it.
+    VrptwSolution run(const VrptwSolution& initial, const std::atomic<bool>& stop,
+                      const std::function<void(const VrptwSolution&)>& onImprovement);
+};
@@ -0,0 +1,367 @@
+#pragma once
+
+#include "VrptwBranchAndPrice.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+
+using std::vector;
+using std::cout;
+using std::endl;
+
+namespace {
+
+constexpr double integralityTolerance = 1e-6;
+constexpr double infinity = std::numeric_limits<double>::infinity();
+
+// Route costs are integral, so a bound prunes a node once it reaches upperBound after rounding up.
+bool boundPrunes(double bound, double upperBound) {
+    return std::ceil(bound - integralityTolerance) >= upperBound;
+}
+
+}
+
+
+VrptwBranchAndPrice::VrptwBranchAndPrice(const VrptwInstance& instance, const VrptwArcSet& arcSet, GRBEnv& env,
+                                         int threads, int ngSize, int columnsPerPricing)
+    : instance(instance), arcSet(arcSet), pricing(instance, arcSet, ngSize), columnsPerPricing(columnsPerPricing),
+      master(env), upperBound(infinity) {
+
+    const int N = instance.numberOfNodes;
+
+    master.set(GRB_IntParam_Threads, threads);
+    master.set(GRB_IntParam_OutputFlag, 0);
+    master.set(GRB_IntAttr_ModelSense, GRB_MINIMIZE);
+    master.set(GRB_StringAttr_ModelName, "VRP-TW set covering master");
+
+    // ------ Rows. ---------------
+    for (int i = 1; i < N; ++i) {
+        coverRows.push_back(master.addConstr(GRBLinExpr(), GRB_GREATER_EQUAL, 1));
+    }
+    fleetRow = master.addConstr(GRBLinExpr(), GRB_LESS_EQUAL, instance.fleetSize);
+
+    // ------ Artificial columns, more expensive than visiting every customer by its own vehicle. ---------------
+    double artificialCost = 1;
+    for (int i = 1; i < N; ++i) {
+        artificialCost += 2.0 * instance.distanceMatrix[0][i];
+    }
+    for (int i = 1; i < N; ++i) {
+        GRBColumn column;
+        column.addTerm(1, coverRows[i - 1]);
+        artificials.push_back(master.addVar(0, GRB_INFINITY, artificialCost, GRB_CONTINUOUS, column));
+    }
+
+    // ------ Initial columns: one route per customer. ---------------
+    for (int i = 1; i < N; ++i) {
+        addColumn(VrptwRoute{ { i }, routeCost(instance, { i }) });
+    }
+}
+
+double VrptwBranchAndPrice::elapsed() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool VrptwBranchAndPrice::addColumn(VrptwRoute&& route) {
+    vector<int> arcs = arcSet.routeArcs(route.customers);
+    if (arcs.empty() || !knownRoutes.insert(route.customers).second) {
+        return false;
+    }
+
+    // ng-routes may visit a customer more than once.
+    std::map<int, int> visits;
+    for (int customer : route.customers) {
+        visits[customer]++;
+    }
+    GRBColumn column;
+    for (auto [customer, count] : visits) {
+        column.addTerm(count, coverRows[customer - 1]);
+    }
+    column.addTerm(1, fleetRow);
+
+    GRBVar var = master.addVar(0, GRB_INFINITY, route.cost, GRB_CONTINUOUS, column);
+    columns.push_back({ var, std::move(route), std::move(arcs) });
+    return true;
+}
+
+double VrptwBranchAndPrice::solveNode(const Node& node, double& nodeBound) {
+    const int N = instance.numberOfNodes;
+
+    // Columns using a removed arc are fixed to 0, the pricing never generates them again.
+    vector<GRBVar> vars(columns.size());
+    vector<double> upperBounds(columns.size());
+    for (size_t c = 0; c < columns.size(); ++c) {
+        vars[c] = columns[c].var;
+        bool allowed = std::all_of(columns[c].arcs.begin(), columns[c].arcs.end(), [&](int a) { return node.arcAllowed[a]; });
+        upperBounds[c] = allowed ? GRB_INFINITY : 0;
+    }
+    master.set(GRB_DoubleAttr_UB, vars.data(), upperBounds.data(), (int)vars.size());
+
+    nodeBound = node.bound;
+    vector<double> customerDuals(N, 0);
+    while (true) {
+        master.set(GRB_DoubleParam_TimeLimit, std::max(0.0, timeLimit - elapsed()));
+        master.optimize();
+        if (master.get(GRB_IntAttr_Status) != GRB_OPTIMAL) {
+            return infinity;
+        }
+        double value = master.get(GRB_DoubleAttr_ObjVal);
+
+        double* duals = master.get(GRB_DoubleAttr_Pi, coverRows.data(), (int)coverRows.size());
+        std::copy(duals, duals + coverRows.size(), customerDuals.begin() + 1);
+        delete[] duals;
+        double fleetDual = fleetRow.get(GRB_DoubleAttr_Pi);
+
+        double minReducedCost = 0;
+        vector<VrptwRoute> routes = pricing.negativeRoutes(customerDuals, fleetDual, node.arcAllowed,
+                                                           columnsPerPricing, minReducedCost);
+
+        // Lagrangian bound, valid for every iteration since at most fleetSize routes are used.
+        nodeBound = std::max(nodeBound, value + instance.fleetSize * minReducedCost);
+        if (boundPrunes(nodeBound, upperBound)) {
+            return infinity;
+        }
+
+        int added = 0;
+        for (VrptwRoute& route : routes) {
+            added += addColumn(std::move(route)) ? 1 : 0;
+        }
+        if (added == 0) {
+            // Only a proven LP optimum is a bound, routes already in the master may still price out negative.
+            if (minReducedCost >= -integralityTolerance) {
+                nodeBound = value;
+            }
+            return value;
+        }
+        if (outOfTime()) {
+            return value;
+        }
+    }
+}
+
+bool VrptwBranchAndPrice::offerRoutes(vector<vector<int>> routes) {
+    const int N = instance.numberOfNodes;
+
+    // Covering solutions may visit a customer twice, the later visits are shortcut.
+    vector<char> visited(N, 0);
+    vector<VrptwRoute> solution;
+    double cost = 0;
+    for (vector<int>& customers : routes) {
+        vector<int> shortcut;
+        for (int customer : customers) {
+            if (!visited[customer]) {
+                visited[customer] = 1;
+                shortcut.push_back(customer);
+            }
+        }
+        if (shortcut.empty()) {
+            continue;
+        }
+        if (!routeFeasible(instance, shortcut)) {
+            return false; // rounded distances need not satisfy the triangle inequality
+        }
+        int routeCostValue = routeCost(instance, shortcut);
+        cost += routeCostValue;
+        solution.push_back({ std::move(shortcut), routeCostValue });
+    }
+    if ((int)solution.size() > instance.fleetSize || std::count(visited.begin() + 1, visited.end(), 0) > 0) {
+        return false;
+    }
+
+    if (cost < upperBound) {
+        upperBound = cost;
+        bestSolution = { std::move(solution), (int)cost };
+        cout << "B&P incumbent: " << cost << " (" << bestSolution.routes.size() << " routes)" << endl;
+    }
+    return true;
+}
+
+int VrptwBranchAndPrice::repeatedVisitArc(const vector<double>& arcFlows) const {
+    const int N = instance.numberOfNodes;
+
+    // Two different arcs with flow into (or out of) the same customer: fixing either to 1 forbids the other,
+    // fixing it to 0 removes it.
+    for (int customer = 1; customer < N; ++customer) {
+        for (const vector<int>* arcs : { &arcSet.incoming[customer], &arcSet.outgoing[customer] }) {
+            int first = -1;
+            for (int a : *arcs) {
+                if (arcFlows[a] <= integralityTolerance) {
+                    continue;
+                }
+                if (first >= 0) {
+                    return first;
+                }
+                first = a;
+            }
+        }
+    }
+    return -1;
+}
+
+void VrptwBranchAndPrice::addSolution(const VrptwSolution& solution) {
+    vector<vector<int>> routes;
+    for (const VrptwRoute& route : solution.routes) {
+        addColumn(VrptwRoute(route));
+        routes.push_back(route.customers);
+    }
+    offerRoutes(std::move(routes));
+}
+
+void VrptwBranchAndPrice::restrictedMasterHeuristic() {
+    for (Column& column : columns) {
+        column.var.set(GRB_CharAttr_VType, GRB_BINARY);
+    }
+    master.set(GRB_DoubleParam_TimeLimit, std::max(0.0, std::min(timeLimit - elapsed(), std::max(5.0, timeLimit / 20))));
+    master.optimize();
+
+    if (master.get(GRB_IntAttr_SolCount) > 0) {
+        bool usesArtificial = std::any_of(artificials.begin(), artificials.end(),
+                                          [](const GRBVar& var) { return var.get(GRB_DoubleAttr_X) > integralityTolerance; });
+        if (!usesArtificial) {
+            vector<vector<int>> routes;
+            for (const Column& column : columns) {
+                if (column.var.get(GRB_DoubleAttr_X) > 0.5) {
+                    routes.push_back(column.route.customers);
+                }
+            }
+            offerRoutes(std::move(routes));
+        }
+    }
+
+    for (Column& column : columns) {
+        column.var.set(GRB_CharAttr_VType, GRB_CONTINUOUS);
+    }
+}
+
+void VrptwBranchAndPrice::run(double timeLimit) {
+    this->timeLimit = timeLimit;
+    start = std::chrono::steady_clock::now();
+
+    // Best bound first, the heap is kept in a vector to read the global lower bound.
+    auto worseBound = [](const Node& a, const Node& b) { return a.bound > b.bound; };
+    vector<Node> open;
+    open.push_back({ 0, vector<char>(arcSet.arcs.size(), 1) });
+    double unresolvedBound = infinity; // nodes left without branching or incumbent
+
+    while (!open.empty() && !outOfTime()) {
+        std::pop_heap(open.begin(), open.end(), worseBound);
+        Node node = std::move(open.back());
+        open.pop_back();
+        if (boundPrunes(node.bound, upperBound)) {
+            continue;
+        }
+        numberOfNodes++;
+
+        double nodeBound;
+        double value = solveNode(node, nodeBound);
+        if (outOfTime()) {
+            node.bound = std::max(node.bound, nodeBound);
+            open.push_back(std::move(node));
+            std::push_heap(open.begin(), open.end(), worseBound);
+            break;
+        }
+        if (value == infinity || boundPrunes(value, upperBound)) {
+            continue;
+        }
+
+        vector<GRBVar> vars(columns.size());
+        for (size_t c = 0; c < columns.size(); ++c) {
+            vars[c] = columns[c].var;
+        }
+        double* lambda = master.get(GRB_DoubleAttr_X, vars.data(), (int)vars.size());
+        bool feasible = std::none_of(artificials.begin(), artificials.end(),
+                                     [](const GRBVar& var) { return var.get(GRB_DoubleAttr_X) > integralityTolerance; });
+
+        // ------ Arc flows of the master solution. ---------------
+        vector<double> arcFlows(arcSet.arcs.size(), 0);
+        bool integral = true;
+        vector<vector<int>> routes;
+        for (size_t c = 0; c < columns.size(); ++c) {
+            if (lambda[c] <= integralityTolerance) {
+                continue;
+            }
+            for (int a : columns[c].arcs) {
+                arcFlows[a] += lambda[c];
+            }
+            if (std::abs(lambda[c] - std::round(lambda[c])) > integralityTolerance) {
+                integral = false;
+            }
+            else {
+                routes.push_back(columns[c].route.customers);
+            }
+        }
+        delete[] lambda;
+
+        if (!feasible) {
+            continue;
+        }
+        if (integral && offerRoutes(std::move(routes))) {
+            continue;
+        }
+        // Integral but rejected routes visit a customer twice and are branched on like fractional ones.
+        if (!integral && (numberOfNodes == 1 || numberOfNodes % 50 == 0)) {
+            restrictedMasterHeuristic();
+            if (boundPrunes(value, upperBound)) {
+                continue;
+            }
+        }
+
+        // ------ Branch on the arc whose flow is closest to 0.5. ---------------
+        int branchArc = -1;
+        double bestDistance = 0.5 - integralityTolerance;
+        for (size_t a = 0; a < arcFlows.size(); ++a) {
+            double distance = std::abs(arcFlows[a] - std::floor(arcFlows[a]) - 0.5);
+            if (distance < bestDistance) {
+                bestDistance = distance;
+                branchArc = (int)a;
+            }
+        }
+        if (branchArc < 0) {
+            branchArc = repeatedVisitArc(arcFlows);
+        }
+        if (branchArc < 0) {
+            // Integral arc flows with fractional routes, the restricted master MIP recovers the routes.
+            // The node is not resolved, its bound stays in the lower bound.
+            restrictedMasterHeuristic();
+            unresolvedBound = std::min(unresolvedBound, value);
+            continue;
+        }
+
+        auto [i, j] = arcSet.arcs[branchArc];
+
+        Node withoutArc{ value, node.arcAllowed };
+        withoutArc.arcAllowed[branchArc] = 0;
+
+        // x_ij = 1: no other arc leaves customer i or enters customer j.
+        Node withArc{ value, node.arcAllowed };
+        if (i != 0) {
+            for (int a : arcSet.outgoing[i]) {
+                if (a != branchArc) {withArc.arcAllowed[a] = 0;}
+            }
+        }
+        if (j != instance.numberOfNodes) {
+            for (int a : arcSet.incoming[j]) {
+                if (a != branchArc) {withArc.arcAllowed[a] = 0;}
+            }
+        }
+
+        open.push_back(std::move(withoutArc));
+        std::push_heap(open.begin(), open.end(), worseBound);
+        open.push_back(std::move(withArc));
+        std::push_heap(open.begin(), open.end(), worseBound);
+    }
+
+    lowerBound = std::min(upperBound, unresolvedBound);
+    for (const Node& node : open) {
+        lowerBound = std::min(lowerBound, node.bound);
+    }
+
+    cout << "B&P nodes: " << numberOfNodes << ", columns: " << columns.size()
+         << ", bounds: [" << lowerBound << ", " << upperBound << "]" << endl;
+}
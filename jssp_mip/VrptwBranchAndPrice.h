@@ -0,0 +1,87 @@
+#pragma once
+
+#include "VrptwInstance.h"
+#include "VrptwPreprocessing.h"
+#include "VrptwPricing.h"
+
+#include "gurobi_c++.h"
+
+#include <chrono>
+#include <set>
+#include <vector>
+
+
+/**
+ Branch-and-price for the VRPTW.
+ The master is the set-covering LP over routes with a fleet size row, solved with Gurobi.
+ Columns come from the ng-route labeling of VrptwPricing, branching fixes arc flows x_ij to 0 or 1.
+ Every customer has an artificial column with a prohibitive cost, so the master stays feasible under branching.
+ */
+class VrptwBranchAndPrice {
+    struct Column {
+        GRBVar var;
+        VrptwRoute route;
+        std::vector<int> arcs; // indices into arcSet.arcs, in visiting order
+    };
+
+    struct Node {
+        double bound;                 // LP bound of the parent
+        std::vector<char> arcAllowed; // arcs not removed by branching
+    };
+
+    const VrptwInstance& instance;
+    const VrptwArcSet& arcSet;
+    VrptwPricing pricing;
+    int columnsPerPricing;
+
+    GRBModel master;
+    std::vector<GRBConstr> coverRows; // coverRows[i - 1] for customer i
+    GRBConstr fleetRow;
+    std::vector<GRBVar> artificials;
+    std::vector<Column> columns;
+    std::set<std::vector<int>> knownRoutes;
+
+    std::chrono::steady_clock::time_point start;
+    double timeLimit = 0;
+
+    VrptwSolution bestSolution;
+    double upperBound;
+    double lowerBound = 0;
+    long long numberOfNodes = 0;
+
+    double elapsed() const;
+    bool outOfTime() const { return elapsed() >= timeLimit; }
+
+    // Adds the route as a master column, returns false if it was already there or uses a missing arc.
+    bool addColumn(VrptwRoute&& route);
+
+    // Column generation on the node, returns the LP value (infinity if infeasible or pruned by the Lagrangian bound).
+    // nodeBound returns the best valid bound of the node, also when column generation stopped early.
+    double solveNode(const Node& node, double& nodeBound);
+
+    // Restricted master as MIP over the columns open at the current node, updates the incumbent.
+    void restrictedMasterHeuristic();
+
+    // Accepts routes covering every customer, repeated visits are shortcut first. Returns false if the routes are
+    // rejected (a shortcut route is infeasible, the fleet is exceeded), true otherwise, also when not improving.
+    bool offerRoutes(std::vector<std::vector<int>> routes);
+
+    // Arc entering or leaving a customer visited more than once by the arc flows, both of its branches cut off
+    // the current master solution. -1 if there is none.
+    int repeatedVisitArc(const std::vector<double>& arcFlows) const;
+
+public:
+    VrptwBranchAndPrice(const VrptwInstance& instance, const VrptwArcSet& arcSet, GRBEnv& env, int threads,
+                        int ngSize, int columnsPerPricing);
+
+    // Known solution (heuristic), its routes become columns and it is the first incumbent.
+    void addSolution(const VrptwSolution& solution);
+
+    void run(double timeLimit);
+
+    const VrptwSolution& getSolution() const { return bestSolution; }
+    double getUpperBound() const { return upperBound; }
+    double getLowerBound() const { return lowerBound; }
+    long long getNumberOfNodes() const { return numberOfNodes; }
+    bool hasSolution() const { return !bestSolution.routes.empty(); }
+};
@@ -0,0 +1,246 @@
+#pragma once
+
+#include "VrptwCallback.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+
+using std::vector;
+
+namespace {
+
+constexpr double cutTolerance = 1e-4;
+
+// Customers i, j are in the same component if x_ij + x_ji > 0.
+struct DisjointSets {
+    vector<int> parent;
+
+    explicit DisjointSets(int size) : parent(size) {
+        std::iota(parent.begin(), parent.end(), 0);
+    }
+
+    int find(int i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    }
+
+    void unite(int i, int j) {
+        parent[find(i)] = find(j);
+    }
+};
+
+}
+
+
+VrptwCallback::VrptwCallback(const VrptwInstance& instance, const VrptwArcSet& arcSet, GRBVar* x, int maxCutsPerNode)
+    : instance(instance), arcSet(arcSet), x(x), maxCutsPerNode(maxCutsPerNode) {
+}
+
+bool VrptwCallback::addCapacityCut(const vector<int>& customers) {
+    const int N = instance.numberOfNodes;
+
+    vector<bool> inSet(N + 1, false);
+    int demand = 0;
+    for (int i : customers) {
+        inSet[i] = true;
+        demand += instance.demands[i];
+    }
+    if (!addedCuts.insert(inSet).second) {
+        return false;
+    }
+
+    // Vehicles entering S, every arc (i, j) with i outside and j inside.
+    GRBLinExpr entering = 0;
+    for (int j : customers) {
+        for (int a : arcSet.incoming[j]) {
+            if (!inSet[arcSet.arcs[a].first]) {
+                entering += x[a];
+            }
+        }
+    }
+    int vehicles = (demand + instance.vehicleCapacity - 1) / instance.vehicleCapacity;
+    addCut(entering, GRB_GREATER_EQUAL, vehicles);
+    numberOfCuts++;
+    return true;
+}
+
+void VrptwCallback::componentSets(const vector<vector<double>>& weights, vector<vector<int>>& violatedSets) {
+    const int N = instance.numberOfNodes;
+
+    DisjointSets components(N);
+    for (int i = 1; i < N; ++i) {
+        for (int j = i + 1; j < N; ++j) {
+            if (weights[i][j] > cutTolerance) {
+                components.unite(i, j);
+            }
+        }
+    }
+
+    vector<vector<int>> members(N);
+    for (int i = 1; i < N; ++i) {
+        members[components.find(i)].push_back(i);
+    }
+
+    for (const vector<int>& S : members) {
+        if (S.size() < 2) {
+            continue;
+        }
+        // Each customer is entered once, so x(delta-(S)) = |S| - x(E(S)).
+        double inside = 0;
+        int demand = 0;
+        for (size_t a = 0; a < S.size(); ++a) {
+            demand += instance.demands[S[a]];
+            for (size_t b = a + 1; b < S.size(); ++b) {
+                inside += weights[S[a]][S[b]];
+            }
+        }
+        int vehicles = (demand + instance.vehicleCapacity - 1) / instance.vehicleCapacity;
+        if (S.size() - inside < vehicles - cutTolerance) {
+            violatedSets.push_back(S);
+        }
+    }
+}
+
+void VrptwCallback::shrinkAndGrowSets(const vector<vector<double>>& weights, vector<vector<int>>& violatedSets) {
+    const int N = instance.numberOfNodes;
+    const int Q = instance.vehicleCapacity;
+
+    // ------ Shrink customers joined by an edge of weight >= 1. ---------------
+    DisjointSets shrunk(N);
+    for (int i = 1; i < N; ++i) {
+        for (int j = i + 1; j < N; ++j) {
+            if (weights[i][j] >= 1 - cutTolerance) {
+                shrunk.unite(i, j);
+            }
+        }
+    }
+
+    vector<int> superNodeOf(N, -1);
+    vector<vector<int>> superNodes;
+    for (int i = 1; i < N; ++i) {
+        int root = shrunk.find(i);
+        if (superNodeOf[root] < 0) {
+            superNodeOf[root] = (int)superNodes.size();
+            superNodes.emplace_back();
+        }
+        superNodeOf[i] = superNodeOf[root];
+        superNodes[superNodeOf[i]].push_back(i);
+    }
+
+    const int n = (int)superNodes.size();
+    vector<vector<double>> superWeights(n, vector<double>(n, 0));
+    vector<double> internalWeight(n, 0);
+    vector<int> superDemand(n, 0);
+    for (int i = 1; i < N; ++i) {
+        superDemand[superNodeOf[i]] += instance.demands[i];
+        for (int j = i + 1; j < N; ++j) {
+            int u = superNodeOf[i], v = superNodeOf[j];
+            if (u == v) {
+                internalWeight[u] += weights[i][j];
+            }
+            else {
+                superWeights[u][v] += weights[i][j];
+                superWeights[v][u] += weights[i][j];
+            }
+        }
+    }
+
+    // ------ Grow a set from every super node, adding the most connected neighbour. ---------------
+    vector<char> inSet(n);
+    vector<double> connection(n);
+    for (int seed = 0; seed < n; ++seed) {
+        std::fill(inSet.begin(), inSet.end(), 0);
+        connection = superWeights[seed];
+        inSet[seed] = 1;
+
+        vector<int> S = { seed };
+        int size = (int)superNodes[seed].size();
+        int demand = superDemand[seed];
+        double inside = internalWeight[seed];
+
+        while (true) {
+            int vehicles = (demand + Q - 1) / Q;
+            if (S.size() > 1 && size - inside < vehicles - cutTolerance) {
+                vector<int> customers;
+                for (int u : S) {
+                    customers.insert(customers.end(), superNodes[u].begin(), superNodes[u].end());
+                }
+                violatedSets.push_back(std::move(customers));
+                break;
+            }
+            if (2 * size >= N - 1) {
+                break;
+            }
+
+            int next = -1;
+            for (int v = 0; v < n; ++v) {
+                if (!inSet[v] && connection[v] > cutTolerance && (next < 0 || connection[v] > connection[next])) {
+                    next = v;
+                }
+            }
+            if (next < 0) {
+                break;
+            }
+
+            inSet[next] = 1;
+            S.push_back(next);
+            size += (int)superNodes[next].size();
+            demand += superDemand[next];
+            inside += internalWeight[next] + connection[next];
+            for (int v = 0; v < n; ++v) {
+                connection[v] += superWeights[next][v];
+            }
+        }
+    }
+}
+
+void VrptwCallback::separateCapacityCuts() {
+    const int N = instance.numberOfNodes;
+    const int numberOfArcs = (int)arcSet.arcs.size();
+
+    double* values = getNodeRel(x, numberOfArcs);
+
+    // Undirected weights x_ij + x_ji between customers.
+    vector<vector<double>> weights(N, vector<double>(N, 0));
+    for (int a = 0; a < numberOfArcs; ++a) {
+        auto [i, j] = arcSet.arcs[a];
+        if (i == 0 || j == N || values[a] <= cutTolerance) {
+            continue;
+        }
+        weights[i][j] += values[a];
+        weights[j][i] += values[a];
+    }
+    delete[] values;
+
+    vector<vector<int>> violatedSets;
+    componentSets(weights, violatedSets);
+    shrinkAndGrowSets(weights, violatedSets);
+
+    int added = 0;
+    for (const vector<int>& S : violatedSets) {
+        if (added >= maxCutsPerNode) {
+            break;
+        }
+        if (addCapacityCut(S)) {
+            added++;
+        }
+    }
+}
+
+void VrptwCallback::callback() {
+    try {
+        if (where == GRB_CB_MIPNODE && getIntInfo(GRB_CB_MIPNODE_STATUS) == GRB_OPTIMAL) {
+            separateCapacityCuts();
+        }
+    }
+    catch (GRBException& e) {
+        std::cout << "VRPTW callback error " << e.getErrorCode() << ": " << e.getMessage() << std::endl;
+    }
+}
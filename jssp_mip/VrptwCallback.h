@@ -0,0 +1,43 @@
+#pragma once
+
+#include "VrptwInstance.h"
+#include "VrptwPreprocessing.h"
+
+#include "gurobi_c++.h"
+
+#include <set>
+#include <vector>
+
+
+/**
+ Gurobi callback of the two-index VRPTW model.
+ Rounded capacity inequalities x(delta-(S)) >= ceil(d(S) / Q) are separated on the fractional node relaxation
+ with a connected-component heuristic and a shrink-and-grow heuristic on the customer support graph.
+ The model needs PreCrush set so the cuts can be applied to the presolved model.
+ */
+class VrptwCallback : public GRBCallback {
+    const VrptwInstance& instance;
+    const VrptwArcSet& arcSet;
+    GRBVar* x;
+
+    int maxCutsPerNode;
+    int numberOfCuts = 0;
+    std::set<std::vector<bool>> addedCuts; // customer sets already cut off
+
+    // Customer sets violating the rounded capacity inequality under the edge weights.
+    void componentSets(const std::vector<std::vector<double>>& weights, std::vector<std::vector<int>>& violatedSets);
+    void shrinkAndGrowSets(const std::vector<std::vector<double>>& weights, std::vector<std::vector<int>>& violatedSets);
+
+    // Adds the cut for the customers, returns false if it was added before.
+    bool addCapacityCut(const std::vector<int>& customers);
+
+    void separateCapacityCuts();
+
+protected:
+    void callback();
+
+public:
+    VrptwCallback(const VrptwInstance& instance, const VrptwArcSet& arcSet, GRBVar* x, int maxCutsPerNode = 20);
+
+    int getNumberOfCuts() const { return numberOfCuts; }
+};
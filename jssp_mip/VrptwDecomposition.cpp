@@ -0,0 +1,234 @@
+#pragma once
+
+#include "VrptwDecomposition.h"
+#include "ModelBuilder.h"
+
+#include <gurobi_c++.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <vector>
+
+
+using std::vector;
+
+namespace {
+
+constexpr int maxClusteringIterations = 20;
+constexpr double clusterSlack = 1.15;
+constexpr double timeWeight = 0.1; // windows only separate customers that are otherwise close
+
+}
+
+
+vector<vector<int>> VrptwDecomposition::clusterCustomers(const VrptwInstance& instance, int clusterSize) {
+    const int N = instance.numberOfNodes;
+    const int customers = N - 1;
+    const int k = std::max(1, (customers + std::max(1, clusterSize) - 1) / std::max(1, clusterSize));
+    if (k == 1) {
+        vector<int> all(customers);
+        std::iota(all.begin(), all.end(), 1);
+        return { all };
+    }
+
+    // ------ Dissimilarity: distance plus scaled difference of the window midpoints. ---------------
+    vector<double> middle(N);
+    for (int i = 1; i < N; ++i) {
+        middle[i] = 0.5 * ((double)instance.timeWindows[i].first + instance.timeWindows[i].second);
+    }
+    double distanceSum = 0, timeSum = 0;
+    for (int i = 1; i < N; ++i) {
+        for (int j = i + 1; j < N; ++j) {
+            distanceSum += instance.distanceMatrix[i][j];
+            timeSum += std::abs(middle[i] - middle[j]);
+        }
+    }
+    const double gamma = timeSum > 0 ? timeWeight * distanceSum / timeSum : 0;
+    auto dissimilarity = [&](int i, int j) {
+        return instance.distanceMatrix[i][j] + gamma * std::abs(middle[i] - middle[j]);
+    };
+
+    const int totalDemand = std::accumulate(instance.demands.begin() + 1, instance.demands.end(), 0);
+    const int sizeLimit = (int)std::ceil(clusterSlack * customers / k);
+    const double demandLimit = clusterSlack * totalDemand / k;
+
+    // ------ Initial medoids: farthest from the depot, then farthest from the chosen ones. ---------------
+    vector<int> medoids;
+    vector<double> nearest(N, std::numeric_limits<double>::infinity());
+    int next = 1;
+    for (int i = 2; i < N; ++i) {
+        if (instance.distanceMatrix[0][i] > instance.distanceMatrix[0][next]) {next = i;}
+    }
+    while ((int)medoids.size() < k) {
+        medoids.push_back(next);
+        for (int i = 1; i < N; ++i) {
+            nearest[i] = std::min(nearest[i], dissimilarity(i, next));
+        }
+        next = (int)(std::max_element(nearest.begin() + 1, nearest.end()) - nearest.begin());
+    }
+
+    vector<vector<int>> clusters;
+    for (int iteration = 0; iteration < maxClusteringIterations; ++iteration) {
+        // ------ Assignment: largest regret first, nearest medoid with room left for the customer and its demand. ---------------
+        vector<vector<double>> cost(N, vector<double>(k));
+        vector<pair<double, int>> order;
+        for (int i = 1; i < N; ++i) {
+            for (int c = 0; c < k; ++c) {
+                cost[i][c] = dissimilarity(i, medoids[c]);
+            }
+            vector<double> sorted = cost[i];
+            std::partial_sort(sorted.begin(), sorted.begin() + 2, sorted.end());
+            order.emplace_back(-(sorted[1] - sorted[0]), i);
+        }
+        std::sort(order.begin(), order.end());
+
+        clusters.assign(k, {});
+        vector<int> demand(k, 0);
+        for (const auto& entry : order) {
+            const int i = entry.second;
+            // k * sizeLimit >= N-1, some cluster always has room for the customer, if none for its demand too
+            // the least loaded one takes it.
+            int best = -1, fallback = -1;
+            for (int c = 0; c < k; ++c) {
+                if ((int)clusters[c].size() >= sizeLimit) {continue;}
+                if (demand[c] + instance.demands[i] <= demandLimit && (best < 0 || cost[i][c] < cost[i][best])) {best = c;}
+                if (fallback < 0 || demand[c] < demand[fallback]) {fallback = c;}
+            }
+            const int c = best >= 0 ? best : fallback;
+            clusters[c].push_back(i);
+            demand[c] += instance.demands[i];
+        }
+
+        // ------ Update: the member closest to all other members. ---------------
+        bool changed = false;
+        for (int c = 0; c < k; ++c) {
+            if (clusters[c].empty()) {continue;}
+            int bestMedoid = medoids[c];
+            double bestSum = std::numeric_limits<double>::infinity();
+            for (int candidate : clusters[c]) {
+                double sum = 0;
+                for (int member : clusters[c]) {
+                    sum += dissimilarity(candidate, member);
+                }
+                if (sum < bestSum) {
+                    bestSum = sum;
+                    bestMedoid = candidate;
+                }
+            }
+            changed = changed || bestMedoid != medoids[c];
+            medoids[c] = bestMedoid;
+        }
+        if (!changed) {
+            break;
+        }
+    }
+
+    clusters.erase(std::remove_if(clusters.begin(), clusters.end(), [](const vector<int>& cluster) { return cluster.empty(); }),
+                   clusters.end());
+    return clusters;
+}
+
+VrptwInstance VrptwDecomposition::subInstance(const VrptwInstance& instance, const vector<int>& customers) {
+    vector<int> nodes = { 0 };
+    nodes.insert(nodes.end(), customers.begin(), customers.end());
+    const int n = (int)nodes.size();
+
+    // Fleet share of the larger of the demand and customer shares, with the clustering slack.
+    const int totalDemand = std::accumulate(instance.demands.begin() + 1, instance.demands.end(), 0);
+    int clusterDemand = 0;
+    for (int customer : customers) {
+        clusterDemand += instance.demands[customer];
+    }
+    const double share = std::max(totalDemand > 0 ? (double)clusterDemand / totalDemand : 0.0,
+                                  (double)customers.size() / std::max(1, instance.numberOfNodes - 1));
+
+    VrptwInstance sub;
+    sub.numberOfNodes = n;
+    sub.vehicleCapacity = instance.vehicleCapacity;
+    sub.fleetSize = std::min(instance.fleetSize, std::max(1, (int)std::ceil(clusterSlack * share * instance.fleetSize)));
+    sub.distanceMatrix = DistanceMatrix(n);
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            sub.distanceMatrix[i][j] = instance.distanceMatrix[nodes[i]][nodes[j]];
+        }
+        sub.demands.push_back(instance.demands[nodes[i]]);
+        sub.timeWindows.push_back(instance.timeWindows[nodes[i]]);
+        sub.serviceTimes.push_back(instance.serviceTimes[nodes[i]]);
+    }
+    return sub;
+}
+
+VrptwSolution VrptwDecomposition::setPartitioning(GRBEnv& env, int threads, const VrptwInstance& instance,
+                                                  const vector<VrptwRoute>& pool, const VrptwSolution& start, double timeLimit) {
+    const int N = instance.numberOfNodes;
+    const int R = (int)pool.size();
+
+    GRBModel model = GRBModel(env);
+    model.set(GRB_IntParam_Threads, threads);
+    model.set(GRB_IntAttr_ModelSense, GRB_MINIMIZE);
+    model.set(GRB_StringAttr_ModelName, "VRP-TW set partitioning over the cluster routes");
+    model.set(GRB_DoubleParam_TimeLimit, std::max(0.0, timeLimit));
+
+    ModelBuilder builder(model);
+
+    // z[r] == 1 iff route r of the pool is used, queued in pool order.
+    for (int r = 0; r < R; ++r) {
+        builder.queueVar(0, 1, pool[r].cost, GRB_BINARY, [&] { return "z_" + std::to_string(r); });
+    }
+    GRBVar* z = builder.addQueuedVars();
+
+    vector<GRBLinExpr> covering(N);
+    GRBLinExpr vehicles = 0;
+    for (int r = 0; r < R; ++r) {
+        for (int customer : pool[r].customers) {
+            covering[customer] += z[r];
+        }
+        vehicles += z[r];
+    }
+    for (int i = 1; i < N; ++i) {
+        builder.queueConstr(std::move(covering[i]), GRB_EQUAL, 1, [&] { return "customer " + std::to_string(i) + " served once."; });
+    }
+    builder.queueConstr(std::move(vehicles), GRB_LESS_EQUAL, instance.fleetSize, [] { return std::string("fleet size."); });
+    builder.addQueuedConstrs();
+
+    // MIP start from the given solution if the pool holds all of its routes.
+    std::map<vector<int>, int> routeIndex;
+    for (int r = 0; r < R; ++r) {
+        routeIndex.emplace(pool[r].customers, r);
+    }
+    vector<double> zStart(R, 0);
+    bool startInPool = !start.routes.empty();
+    for (const VrptwRoute& route : start.routes) {
+        auto found = routeIndex.find(route.customers);
+        if (found == routeIndex.end()) {
+            startInPool = false;
+            break;
+        }
+        zStart[found->second] = 1;
+    }
+    if (startInPool) {
+        model.set(GRB_DoubleAttr_Start, z, zStart.data(), R);
+    }
+
+    model.optimize();
+
+    VrptwSolution solution;
+    if (model.get(GRB_IntAttr_SolCount) > 0) {
+        double* zValues = model.get(GRB_DoubleAttr_X, z, R);
+        for (int r = 0; r < R; ++r) {
+            if (zValues[r] > 0.5) {
+                solution.routes.push_back(pool[r]);
+                solution.cost += pool[r].cost;
+            }
+        }
+        delete[] zValues;
+    }
+    else if (startInPool) {
+        solution = start; // no time left to load the MIP start
+    }
+    delete[] z;
+    return solution;
+}
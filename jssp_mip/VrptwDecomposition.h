@@ -0,0 +1,32 @@
+#pragma once
+
+#include "VrptwInstance.h"
+
+#include <vector>
+
+
+class GRBEnv;
+
+
+/**
+ Building blocks of the cluster-first, route-second decomposition of large VRPTW instances:
+ customers are split into balanced clusters, every cluster is routed as an independent sub-instance,
+ and a set partitioning model picks the cheapest combination of the routes found.
+ */
+class VrptwDecomposition {
+
+public:
+    // Capacity-aware k-medoids on t_ij + gamma |c_i - c_j|, c = window midpoint, gamma a tenth of the distance to time ratio.
+    // k = ceil((N-1) / clusterSize); a cluster takes at most 15% more than its share of the customers and of the demand.
+    static std::vector<std::vector<int>> clusterCustomers(const VrptwInstance& instance, int clusterSize);
+
+    // The depot and the customers, customer k of the list becomes node k+1. Capacity is kept, the fleet is
+    // the cluster's share of it (larger of demand and customer share, 15% slack).
+    static VrptwInstance subInstance(const VrptwInstance& instance, const std::vector<int>& customers);
+
+    // min sum c_r z_r, every customer on exactly one route, at most fleetSize routes, over the route pool.
+    // start (may be empty) is passed as MIP start when all its routes are in the pool, and returned if the model finds
+    // no solution within timeLimit (0 allowed). Otherwise empty solution if none is found.
+    static VrptwSolution setPartitioning(GRBEnv& env, int threads, const VrptwInstance& instance,
+                                         const std::vector<VrptwRoute>& pool, const VrptwSolution& start, double timeLimit);
+};
@@ -0,0 +1,149 @@
+#pragma once
+
+#include "VrptwHeuristics.h"
+
+#include <algorithm>
+#include <limits>
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+using std::vector;
+
+
+VrptwSolution VrptwHeuristics::solomonInsertion(const VrptwInstance& instance, const InsertionParams& params) {
+    const int N = instance.numberOfNodes;
+    const DistanceMatrix& t = instance.distanceMatrix;
+    const vector<pair<int, int>>& tw = instance.timeWindows;
+    const vector<int>& s = instance.serviceTimes;
+
+    VrptwSolution solution;
+    vector<char> routed(N, 0);
+    int unrouted = N - 1;
+
+    while (unrouted > 0) {
+        // ------ Seed a new route. ---------------
+        int seed = -1;
+        for (int u = 1; u < N; ++u) {
+            if (routed[u]) {continue;}
+            if (seed < 0
+                || (params.seed == SeedCriterion::FarthestCustomer && t[0][u] > t[0][seed])
+                || (params.seed == SeedCriterion::EarliestDeadline && tw[u].second < tw[seed].second)) {
+                seed = u;
+            }
+        }
+        vector<int> route = { 0, seed, 0 }; // depot at both ends
+        routed[seed] = 1;
+        unrouted--;
+
+        while (true) {
+            // Earliest and latest service starts along the route, latest[k] keeps the rest of the route feasible.
+            const int length = (int)route.size();
+            vector<long long> start(length), latest(length);
+            start[0] = tw[0].first;
+            for (int k = 1; k < length; ++k) {
+                start[k] = std::max((long long)tw[route[k]].first, start[k - 1] + s[route[k - 1]] + t[route[k - 1]][route[k]]);
+            }
+            latest[length - 1] = tw[0].second;
+            for (int k = length - 2; k >= 0; --k) {
+                latest[k] = std::min((long long)tw[route[k]].second, latest[k + 1] - s[route[k]] - t[route[k]][route[k + 1]]);
+            }
+            int load = 0;
+            for (int k = 1; k < length - 1; ++k) {
+                load += instance.demands[route[k]];
+            }
+
+            // ------ Best position of every unrouted customer (c1), best customer (c2). ---------------
+            int bestCustomer = -1, bestPosition = -1;
+            double bestC2 = -std::numeric_limits<double>::infinity();
+            for (int u = 1; u < N; ++u) {
+                if (routed[u] || load + instance.demands[u] > instance.vehicleCapacity) {continue;}
+
+                double bestC1 = std::numeric_limits<double>::infinity();
+                int position = -1;
+                for (int k = 0; k < length - 1; ++k) {
+                    const int i = route[k], j = route[k + 1];
+                    long long startU = std::max((long long)tw[u].first, start[k] + s[i] + t[i][u]);
+                    if (startU > tw[u].second) {continue;}
+                    long long startJ = std::max((long long)tw[j].first, startU + s[u] + t[u][j]);
+                    if (startJ > latest[k + 1]) {continue;}
+
+                    double c11 = t[i][u] + t[u][j] - params.mu * t[i][j];
+                    double c12 = (double)(startJ - start[k + 1]);
+                    double c1 = params.alpha * c11 + (1 - params.alpha) * c12;
+                    if (c1 < bestC1) {
+                        bestC1 = c1;
+                        position = k + 1;
+                    }
+                }
+                if (position < 0) {continue;}
+
+                double c2 = params.lambda * t[0][u] - bestC1;
+                if (c2 > bestC2) {
+                    bestC2 = c2;
+                    bestCustomer = u;
+                    bestPosition = position;
+                }
+            }
+
+            if (bestCustomer < 0) {
+                break;
+            }
+            route.insert(route.begin() + bestPosition, bestCustomer);
+            routed[bestCustomer] = 1;
+            unrouted--;
+        }
+
+        VrptwRoute vrptwRoute;
+        vrptwRoute.customers.assign(route.begin() + 1, route.end() - 1);
+        vrptwRoute.cost = routeCost(instance, vrptwRoute.customers);
+        solution.cost += vrptwRoute.cost;
+        solution.routes.push_back(std::move(vrptwRoute));
+    }
+
+    return solution;
+}
+
+VrptwSolution VrptwHeuristics::bestInsertionSolution(const VrptwInstance& instance, int threads) {
+    // Parameter sets of Solomon (1987), both seed criteria.
+    vector<InsertionParams> grid;
+    for (SeedCriterion seed : { SeedCriterion::FarthestCustomer, SeedCriterion::EarliestDeadline }) {
+        for (double mu : { 1.0 }) {
+            for (double lambda : { 1.0, 2.0 }) {
+                for (double alpha : { 0.0, 0.5, 1.0 }) {
+                    grid.push_back({ mu, lambda, alpha, seed });
+                }
+            }
+        }
+    }
+
+    vector<VrptwSolution> solutions(grid.size());
+    std::atomic<size_t> next(0);
+    auto evaluate = [&]() {
+        for (size_t k; (k = next++) < grid.size();) {
+            solutions[k] = solomonInsertion(instance, grid[k]);
+        }
+    };
+    if (threads <= 0) {
+        threads = std::max(1, (int)std::thread::hardware_concurrency());
+    }
+    vector<std::thread> workers;
+    for (int t = 1; t < std::min(threads, (int)grid.size()); ++t) {
+        workers.emplace_back(evaluate);
+    }
+    evaluate();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    VrptwSolution best;
+    for (VrptwSolution& solution : solutions) {
+        if ((int)solution.routes.size() > instance.fleetSize) {continue;}
+        if (best.routes.empty() || solution.cost < best.cost) {
+            best = std::move(solution);
+        }
+    }
+    return best;
+}
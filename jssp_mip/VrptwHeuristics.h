@@ -0,0 +1,38 @@
+#pragma once
+
+#include "VrptwInstance.h"
+
+#include <vector>
+
+
+enum class SeedCriterion {
+    FarthestCustomer, // unrouted customer farthest from the depot
+    EarliestDeadline  // unrouted customer with the earliest due date
+};
+
+
+struct InsertionParams {
+    /// <summary>
+    /// Parameters of Solomon's I1 insertion criteria.
+    /// c1 = alpha (d_iu + d_uj - mu d_ij) + (1 - alpha) (push forward at j), c2 = lambda d_0u - c1.
+    /// </summary>
+    double mu = 1;
+    double lambda = 1;
+    double alpha = 1;
+    SeedCriterion seed = SeedCriterion::FarthestCustomer;
+};
+
+
+/**
+ Constructive heuristics producing feasible VRPTW route sets, used as upper bounds and MIP starts.
+ */
+class VrptwHeuristics {
+
+public:
+    // Solomon (1987) I1 sequential insertion. The routes may exceed the fleet size.
+    static VrptwSolution solomonInsertion(const VrptwInstance& instance, const InsertionParams& params);
+
+    // Best I1 solution within the fleet size over a grid of (mu, lambda, alpha) and seed criteria, evaluated on at most
+    // threads threads (0 = one per hardware thread, 1 = sequentially). Empty solution if none fits the fleet.
+    static VrptwSolution bestInsertionSolution(const VrptwInstance& instance, int threads);
+};
@@ -1,9 +1,12 @@
 #pragma once
 
 #include "VrpRepXmlReader.h"
+#include "DistanceMatrix.h"
 
 #include <vector>
+#include <algorithm>
 #include <cmath>
+#include <limits>
 
 
 using std::vector;
@@ -17,46 +20,60 @@ struct VrptwInstance {
     int numberOfNodes;
     int vehicleCapacity;
     int fleetSize;
-    vector<vector<int>> distanceMatrix;
+    DistanceMatrix distanceMatrix; // travel times equal the distances
     vector<int> demands;
     vector<pair<int, int>> timeWindows;
+    vector<int> serviceTimes;
 };
 
 
+struct VrptwRoute {
+    /// <summary>
+    /// Customers visited by one vehicle in order, the depot at both ends is implicit.
+    /// </summary>
+    vector<int> customers;
+    int cost = 0;
+};
 
 
-inline float euclideanDistance2D(pair<float, float>& x, pair<float, float>& y) {
-    return std::sqrt(std::pow(x.first - y.first, 2) + std::pow((x.second - y.second), 2));
-}
-
+struct VrptwSolution {
+    /// <summary>
+    /// Routes serving every customer once, cost = total distance. Empty if no solution is known.
+    /// </summary>
+    vector<VrptwRoute> routes;
+    int cost = 0;
+};
 
-vector<vector<int>> createDistanceMatrixFromCoordinates(vector<pair<float, float>>&& coordinates) {
 
-    vector<vector<int>> distanceMatrix
-    (coordinates.size(), vector<int>(coordinates.size()));
+inline int routeCost(const VrptwInstance& instance, const vector<int>& customers) {
+    int cost = 0, previous = 0;
+    for (int customer : customers) {
+        cost += instance.distanceMatrix[previous][customer];
+        previous = customer;
+    }
+    return cost + instance.distanceMatrix[previous][0];
+}
 
-    int i = 0, j = 0;
-    for (auto& coord1 : coordinates) {
-        for (auto& coord2 : coordinates) {
-            if (i == j) {
-                distanceMatrix[i][j] = 0;
-            }
-            else {
-                int distance = round(euclideanDistance2D(coord1, coord2));
 
-                distanceMatrix[i][j] = distance;
-                distanceMatrix[j][i] = distance;
-            }
-            j++;
+// Capacity and time windows of the route, waiting before a window opens is allowed.
+inline bool routeFeasible(const VrptwInstance& instance, const vector<int>& customers) {
+    int load = 0, time = instance.timeWindows[0].first, previous = 0;
+    for (int customer : customers) {
+        load += instance.demands[customer];
+        time = std::max(instance.timeWindows[customer].first,
+                        time + instance.serviceTimes[previous] + instance.distanceMatrix[previous][customer]);
+        if (time > instance.timeWindows[customer].second) {
+            return false;
         }
-        i++;
-        j = 0;
+        previous = customer;
     }
-
-    return distanceMatrix;
+    long long arrival = (long long)time + instance.serviceTimes[previous] + instance.distanceMatrix[previous][0];
+    return load <= instance.vehicleCapacity && arrival <= instance.timeWindows[0].second;
 }
+
+
 // todo: code would be cleaner if first datastructures made N+1.
-VrptwInstance getInstance(const char* instancePath) {
+inline VrptwInstance getInstance(const char* instancePath) {
     /// Load data. All values are integers, if not they are rounded.
 
     VrpRepXmlReader vrpReader(instancePath);
@@ -67,22 +84,39 @@ VrptwInstance getInstance(const char* instancePath) {
 
     int K = vrpReader.getFleetSize();
 
-    vector<vector<int>> distanceMatrix  // Distances are rounded to the closest int.
-        = createDistanceMatrixFromCoordinates(vrpReader.getNodesCoordinates(N));
+    vector<float> x, y;
+    x.reserve(N);
+    y.reserve(N);
+    for (const auto& coordinates : vrpReader.getNodesCoordinates()) {
+        x.push_back(coordinates.first);
+        y.push_back(coordinates.second);
+    }
+    DistanceMatrix distanceMatrix  // Distances are rounded to the closest int.
+        = DistanceMatrix::euclidean(x, y, DistanceRounding::Nearest);
 
     vector<int> demands;
     demands.reserve(N);
-    for (auto nodeDemand : vrpReader.getNodeDemands(N)) {
+    for (auto nodeDemand : vrpReader.getNodeDemands()) {
         demands.emplace_back((int)nodeDemand);
     }
+    demands[0] = 0;
 
     vector<pair<int, int>> timeWindows;
     timeWindows.reserve(N);
-    for (auto timeWindow : vrpReader.getTimeWindows(N)) {
+    for (auto timeWindow : vrpReader.getTimeWindows()) {
         timeWindows.emplace_back(timeWindow.first, timeWindow.second);
     }
-    timeWindows[0] = pair<int, int>{ 0, std::numeric_limits<int>::max() };
+    // Vehicles leave the depot at 0, the route duration limit is the depot closing time (Solomon's depot due date).
+    int depotClosing = vrpReader.getMaxTravelTime() > 0 ? (int)std::round(vrpReader.getMaxTravelTime()) : std::numeric_limits<int>::max();
+    timeWindows[0] = pair<int, int>{ 0, depotClosing };
+
+    vector<int> serviceTimes;
+    serviceTimes.reserve(N);
+    for (auto serviceTime : vrpReader.getServiceTimes()) {
+        serviceTimes.emplace_back((int)std::round(serviceTime));
+    }
+    serviceTimes[0] = 0;
 
-    return { N, Q, K, distanceMatrix, demands, timeWindows };
+    return { N, Q, K, std::move(distanceMatrix), std::move(demands), std::move(timeWindows), std::move(serviceTimes) };
 }
 
@@ -0,0 +1,207 @@
+#pragma once
+
+#include "VrptwLocalSearch.h"
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+
+using std::vector;
+
+
+VrptwLocalSearch::VrptwLocalSearch(const VrptwInstance& instance, const VrptwLocalSearchParams& params)
+    : instance(instance), params(params), rng(params.seed) {
+
+    const int N = instance.numberOfNodes;
+    const auto& t = instance.distanceMatrix;
+    const auto& tw = instance.timeWindows;
+    const auto& s = instance.serviceTimes;
+
+    // Closest customers that can precede or follow u.
+    neighbours.assign(N, {});
+    for (int u = 1; u < N; ++u) {
+        vector<int> candidates;
+        for (int v = 1; v < N; ++v) {
+            if (v == u) {continue;}
+            bool uv = (long long)tw[u].first + s[u] + t[u][v] <= tw[v].second;
+            bool vu = (long long)tw[v].first + s[v] + t[v][u] <= tw[u].second;
+            if (uv || vu) {candidates.push_back(v);}
+        }
+        int k = std::min((int)candidates.size(), params.neighbours);
+        std::partial_sort(candidates.begin(), candidates.begin() + k, candidates.end(),
+                          [&](int a, int b) { return t[u][a] < t[u][b]; });
+        candidates.resize(k);
+        neighbours[u] = std::move(candidates);
+    }
+}
+
+void VrptwLocalSearch::rebuildRoute(int r) {
+    const vector<int>& route = routes[r];
+    const int n = (int)route.size();
+
+    segments[r].assign(n, {});
+    for (int i = 0; i < n; ++i) {
+        vector<VrptwRouteSegment>& row = segments[r][i];
+        row.reserve(n - i);
+        row.push_back(VrptwRouteSegment::node(instance, route[i]));
+        for (int j = i + 1; j < n; ++j) {
+            row.push_back(VrptwRouteSegment::concatenate(instance, row.back(), VrptwRouteSegment::node(instance, route[j])));
+        }
+    }
+    for (int i = 1; i < n - 1; ++i) {
+        routeOf[route[i]] = r;
+        positionOf[route[i]] = i;
+    }
+}
+
+VrptwRouteSegment VrptwLocalSearch::evaluate(std::initializer_list<Range> ranges) const {
+    VrptwRouteSegment result;
+    bool empty = true;
+    for (const Range& range : ranges) {
+        if (range.from > range.to) {continue;}
+        const VrptwRouteSegment& next = segment(range.route, range.from, range.to);
+        result = empty ? next : VrptwRouteSegment::concatenate(instance, result, next);
+        empty = false;
+    }
+    return result;
+}
+
+vector<int> VrptwLocalSearch::sequence(std::initializer_list<Range> ranges) const {
+    vector<int> nodes;
+    for (const Range& range : ranges) {
+        for (int p = range.from; p <= range.to; ++p) {
+            nodes.push_back(routes[range.route][p]);
+        }
+    }
+    return nodes;
+}
+
+bool VrptwLocalSearch::tryMove(int ru, std::initializer_list<Range> newRu) {
+    VrptwRouteSegment route = evaluate(newRu);
+    if (!route.feasible(instance) || route.distance >= segment(ru, 0, last(ru)).distance) {
+        return false;
+    }
+    routes[ru] = sequence(newRu);
+    rebuildRoute(ru);
+    return true;
+}
+
+bool VrptwLocalSearch::tryMove(int ru, std::initializer_list<Range> newRu, int rv, std::initializer_list<Range> newRv) {
+    // Cheap distance test first, the segments already carry it.
+    VrptwRouteSegment routeU = evaluate(newRu);
+    VrptwRouteSegment routeV = evaluate(newRv);
+    int before = segment(ru, 0, last(ru)).distance + segment(rv, 0, last(rv)).distance;
+    if (routeU.distance + routeV.distance >= before || !routeU.feasible(instance) || !routeV.feasible(instance)) {
+        return false;
+    }
+    vector<int> u = sequence(newRu), v = sequence(newRv);
+    routes[ru] = std::move(u);
+    routes[rv] = std::move(v);
+    rebuildRoute(ru);
+    rebuildRoute(rv);
+    return true;
+}
+
+bool VrptwLocalSearch::relocateMoves(int u, int v) {
+    const int ru = routeOf[u], rv = routeOf[v];
+    const int pu = positionOf[u], pv = positionOf[v];
+
+    for (int length = 1; length <= params.maxChainLength; ++length) {
+        const int chainEnd = pu + length - 1;
+        if (chainEnd >= last(ru)) {break;}
+        const Range chain = { ru, pu, chainEnd };
+
+        // Insert the chain after v or after the predecessor of v.
+        for (int p : { pv, pv - 1 }) {
+            if (ru != rv) {
+                if (tryMove(ru, { { ru, 0, pu - 1 }, { ru, chainEnd + 1, last(ru) } },
+                            rv, { { rv, 0, p }, chain, { rv, p + 1, last(rv) } })) {
+                    return true;
+                }
+            }
+            else if (p < pu - 1) {
+                if (tryMove(ru, { { ru, 0, p }, chain, { ru, p + 1, pu - 1 }, { ru, chainEnd + 1, last(ru) } })) {
+                    return true;
+                }
+            }
+            else if (p > chainEnd) {
+                if (tryMove(ru, { { ru, 0, pu - 1 }, { ru, chainEnd + 1, p }, chain, { ru, p + 1, last(ru) } })) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+bool VrptwLocalSearch::swapMove(int u, int v) {
+    const int ru = routeOf[u], rv = routeOf[v];
+    const int pu = positionOf[u], pv = positionOf[v];
+    if (ru == rv) {
+        return false;
+    }
+    return tryMove(ru, { { ru, 0, pu - 1 }, { rv, pv, pv }, { ru, pu + 1, last(ru) } },
+                   rv, { { rv, 0, pv - 1 }, { ru, pu, pu }, { rv, pv + 1, last(rv) } });
+}
+
+bool VrptwLocalSearch::twoOptStarMove(int u, int v) {
+    const int ru = routeOf[u], rv = routeOf[v];
+    const int pu = positionOf[u], pv = positionOf[v];
+    if (ru == rv) {
+        return false;
+    }
+    // New arc (u, v): the head of ru up to u continues with the tail of rv from v.
+    return tryMove(ru, { { ru, 0, pu }, { rv, pv, last(rv) } },
+                   rv, { { rv, 0, pv - 1 }, { ru, pu + 1, last(ru) } });
+}
+
+bool VrptwLocalSearch::improve(VrptwSolution& solution) {
+    const int N = instance.numberOfNodes;
+    routes.clear();
+    segments.clear();
+    routeOf.assign(N, -1);
+    positionOf.assign(N, -1);
+
+    for (const VrptwRoute& route : solution.routes) {
+        vector<int> nodes = { 0 };
+        nodes.insert(nodes.end(), route.customers.begin(), route.customers.end());
+        nodes.push_back(0);
+        routes.push_back(std::move(nodes));
+        segments.emplace_back();
+        rebuildRoute((int)routes.size() - 1);
+    }
+
+    vector<int> order;
+    for (int u = 1; u < N; ++u) {
+        if (routeOf[u] >= 0) {order.push_back(u);}
+    }
+
+    bool improved = false, changed = true;
+    while (changed) {
+        changed = false;
+        std::shuffle(order.begin(), order.end(), rng);
+        for (int u : order) {
+            for (int v : neighbours[u]) {
+                if (routeOf[v] < 0) {continue;}
+                bool moved = (params.relocate && relocateMoves(u, v))
+                          || (params.swap && swapMove(u, v))
+                          || (params.twoOptStar && twoOptStarMove(u, v));
+                changed = changed || moved;
+            }
+        }
+        improved = improved || changed;
+    }
+
+    int before = solution.cost;
+    solution = VrptwSolution();
+    for (const vector<int>& route : routes) {
+        if (route.size() <= 2) {continue;}
+        VrptwRoute result;
+        result.customers.assign(route.begin() + 1, route.end() - 1);
+        result.cost = routeCost(instance, result.customers);
+        solution.cost += result.cost;
+        solution.routes.push_back(std::move(result));
+    }
+    return improved && solution.cost < before;
+}
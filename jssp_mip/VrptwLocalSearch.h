@@ -0,0 +1,64 @@
+#pragma once
+
+#include "VrptwInstance.h"
+#include "VrptwRouteSegment.h"
+
+#include <initializer_list>
+#include <random>
+#include <vector>
+
+
+struct VrptwLocalSearchParams {
+    /// <summary>
+    /// Neighbourhoods of the VRPTW local search, moves are only tried between a customer and its closest neighbours.
+    /// </summary>
+    int neighbours = 20;       // granularity: closest time-compatible customers per customer
+    int maxChainLength = 3;    // relocate / Or-opt moves chains of 1..maxChainLength consecutive customers
+    bool relocate = true;      // chain to another position, in the same route (Or-opt) or another route
+    bool swap = true;          // exchange two customers of different routes
+    bool twoOptStar = true;    // exchange the tails of two routes
+    unsigned int seed = 0;
+};
+
+
+/**
+ First-improvement local search over relocate / Or-opt, swap and 2-opt* moves.
+ Every route caches the segments of all its subsequences, so a move is checked for time windows and capacity
+ by concatenating at most four segments in O(1); a route is rebuilt only when a move changes it.
+ */
+class VrptwLocalSearch {
+    struct Range {
+        int route, from, to; // positions in routes[route], inclusive, skipped if from > to
+    };
+
+    const VrptwInstance& instance;
+    VrptwLocalSearchParams params;
+    std::mt19937 rng;
+    std::vector<std::vector<int>> neighbours;
+
+    std::vector<std::vector<int>> routes;                           // 0, customers..., 0
+    std::vector<std::vector<std::vector<VrptwRouteSegment>>> segments; // segments[r][i][j - i] = positions i..j of route r
+    std::vector<int> routeOf, positionOf;
+
+    const VrptwRouteSegment& segment(int r, int from, int to) const { return segments[r][from][to - from]; }
+    int last(int r) const { return (int)routes[r].size() - 1; }
+
+    void rebuildRoute(int r);
+    VrptwRouteSegment evaluate(std::initializer_list<Range> ranges) const;
+    std::vector<int> sequence(std::initializer_list<Range> ranges) const;
+
+    // Applies the move if the new routes are feasible and shorter, ranges describe the new route(s).
+    bool tryMove(int ru, std::initializer_list<Range> newRu);
+    bool tryMove(int ru, std::initializer_list<Range> newRu, int rv, std::initializer_list<Range> newRv);
+
+    bool relocateMoves(int u, int v);
+    bool swapMove(int u, int v);
+    bool twoOptStarMove(int u, int v);
+
+public:
+    VrptwLocalSearch(const VrptwInstance& instance, const VrptwLocalSearchParams& params);
+
+    // Improves a feasible solution to a local optimum in place, routes that become empty are dropped.
+    // Returns true if the cost decreased.
+    bool improve(VrptwSolution& solution);
+};
@@ -2,13 +2,29 @@
 
 # include "VrptwMIP.h"
 # include "VrptwInstance.h"
+# include "VrptwPreprocessing.h"
+# include "VrptwCallback.h"
+# include "VrptwBranchAndPrice.h"
+# include "VrptwHeuristics.h"
+# include "VrptwAlns.h"
+# include "VrptwDecomposition.h"
 # include "VrpRepXmlReader.h"
+# include "InstanceCache.h"
+# include "ModelBuilder.h"
 
 # include <gurobi_c++.h>
 
+# include <algorithm>
+# include <atomic>
+# include <chrono>
 # include <vector>
 # include <cmath>
+# include <exception>
 # include <limits>
+# include <mutex>
+# include <set>
+# include <thread>
+# include <utility>
 
 using std::vector;
 using std::pair;
@@ -17,151 +33,713 @@ using std::cout;
 using std::endl;
 
 
-void  VrptwMIP::solveInstance(const char* instancePath, float timeLimit) {
-    VrptwInstance instance = getInstance(instancePath);
-    
-    twoIndexVehicleFlowFormulation(instance.numberOfNodes, instance.vehicleCapacity, instance.fleetSize, 
-                                   instance.distanceMatrix, instance.demands, instance.timeWindows, timeLimit);
+namespace {
+
+constexpr double clusterTimeShare = 0.7; // decomposition: share of the time limit for the cluster MIPs
+
+// License, WLS and Compute Server settings, copied from the caller's environment into the decomposition workers'.
+constexpr GRB_StringParam connectionStringParams[] = {
+    GRB_StringParam_ComputeServer, GRB_StringParam_ServerPassword, GRB_StringParam_TokenServer,
+    GRB_StringParam_CSManager, GRB_StringParam_CSRouter, GRB_StringParam_CSGroup,
+    GRB_StringParam_CSAPIAccessID, GRB_StringParam_CSAPISecret,
+    GRB_StringParam_CloudAccessID, GRB_StringParam_CloudSecretKey, GRB_StringParam_CloudPool,
+    GRB_StringParam_WLSAccessID, GRB_StringParam_WLSSecret
+};
+constexpr GRB_IntParam connectionIntParams[] = {
+    GRB_IntParam_LicenseID, GRB_IntParam_ServerTimeout, GRB_IntParam_CSPriority, GRB_IntParam_TSPort, GRB_IntParam_CSTLSInsecure
+};
+
+// Routes of the arcs with value 1, arcValues[a] belongs to arcSet.arcs[a].
+VrptwSolution readRoutes(const VrptwInstance& instance, const VrptwArcSet& arcSet, const vector<double>& arcValues) {
+    const int N = instance.numberOfNodes;
+
+    VrptwSolution solution;
+    for (int first : arcSet.outgoing[0]) {
+        if (arcValues[first] < 0.5) {continue;}
+
+        VrptwRoute route;
+        int node = arcSet.arcs[first].second;
+        while (node != N && (int)route.customers.size() < N) {
+            route.customers.push_back(node);
+            int next = N;
+            for (int a : arcSet.outgoing[node]) {
+                if (arcValues[a] > 0.5) {
+                    next = arcSet.arcs[a].second;
+                    break;
+                }
+            }
+            node = next;
+        }
+        route.cost = routeCost(instance, route.customers);
+        solution.cost += route.cost;
+        solution.routes.push_back(std::move(route));
+    }
+    return solution;
+}
 
+void printSolution(const VrptwSolution& solution, bool optimal) {
+    cout << "\n==================================" << endl;
+    cout << "tour cost: " << solution.cost << (optimal ? " (optimal)" : "") << endl;
+    for (const VrptwRoute& route : solution.routes) {
+        for (int customer : route.customers) {
+            cout << customer << " ";
+        }
+        cout << endl;
+    }
+    cout << "==================================\n";
 }
 
+}
 
-void VrptwMIP::twoIndexVehicleFlowFormulation(int numberOfNodes, int vehicleCapacity, int fleetSize,
-                                              vector<vector<int>> distanceMatrix, 
-                                              vector<int> demands,
-                                              vector<pair<int, int>> timeWindows, 
-                                              float timeLimit){
-    /// MIP two-index flow formulation for C-VRP-TW, as in https://arxiv.org/pdf/1606.01935.pdf, pg.4, equations (2.1)-(2.9).
+
+void  VrptwMIP::solveInstance(const char* instancePath, float timeLimit) {
+    result = SolveResult{ instancePath };
+    VrptwInstance instance = InstanceCache::loadVrptw(instancePath);
+
+    if (params.tightenTimeWindows) {
+        int tightened = VrptwPreprocessing::tightenTimeWindows(instance);
+        cout << "Time window tightening changed " << tightened << " of " << instance.numberOfNodes - 1 << " windows." << endl;
+    }
+
+    VrptwArcSet arcSet = VrptwPreprocessing::feasibleArcs(instance);
+    cout << "Arc elimination kept " << arcSet.arcs.size() << " of "
+         << (instance.numberOfNodes + 1) * (instance.numberOfNodes + 1) << " arcs." << endl;
+
+    VrptwSolution heuristicSolution;
+    if (params.warmStart) {
+        heuristicSolution = VrptwHeuristics::bestInsertionSolution(instance, threads);
+        if (!heuristicSolution.routes.empty()) {
+            cout << "I1 insertion: " << heuristicSolution.cost << " (" << heuristicSolution.routes.size() << " routes)" << endl;
+        }
+    }
+
+    if (params.formulation == VrptwFormulation::Alns || params.alnsTimeLimit > 0) {
+        VrptwAlnsParams alnsParams;
+        alnsParams.threads = threads;
+        alnsParams.timeLimit = params.formulation == VrptwFormulation::Alns ? timeLimit : std::min(params.alnsTimeLimit, (double)timeLimit);
+
+        auto start = std::chrono::steady_clock::now();
+        std::atomic<bool> stop(false);
+        VrptwAlns alns(instance, alnsParams);
+        VrptwSolution alnsSolution = alns.run(heuristicSolution, stop, [](const VrptwSolution& solution) {
+            cout << "ALNS: " << solution.cost << " (" << solution.routes.size() << " routes)" << endl;
+        });
+        if (!alnsSolution.routes.empty()
+            && (heuristicSolution.routes.empty() || alnsSolution.cost < heuristicSolution.cost)) {
+            heuristicSolution = std::move(alnsSolution);
+        }
+
+        double alnsTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (params.formulation == VrptwFormulation::Alns) {
+            // No solution found is no proof of infeasibility.
+            bool found = !heuristicSolution.routes.empty();
+            result.status = GRB_TIME_LIMIT;
+            result.solutionCount = found ? 1 : 0;
+            result.objective = heuristicSolution.cost;
+            result.gap = GRB_INFINITY;
+            result.runtime = alnsTime;
+            if (found) {
+                printSolution(heuristicSolution, false);
+            }
+            return;
+        }
+        // The exact model gets what is left of the time limit.
+        timeLimit = (float)std::max(0.0, timeLimit - alnsTime);
+    }
+
+    if (params.formulation == VrptwFormulation::BranchAndPrice) {
+        VrptwBranchAndPrice branchAndPrice(instance, arcSet, getEnv(), threads, params.ngSize, params.columnsPerPricing);
+        if (!heuristicSolution.routes.empty()) {
+            branchAndPrice.addSolution(heuristicSolution);
+        }
+        auto start = std::chrono::steady_clock::now();
+        branchAndPrice.run(timeLimit);
+
+        bool closed = branchAndPrice.getLowerBound() >= branchAndPrice.getUpperBound();
+        result.status = closed ? (branchAndPrice.hasSolution() ? GRB_OPTIMAL : GRB_INFEASIBLE) : GRB_TIME_LIMIT;
+        result.solutionCount = branchAndPrice.hasSolution() ? 1 : 0;
+        result.objective = branchAndPrice.getUpperBound();
+        result.bound = branchAndPrice.getLowerBound();
+        result.gap = branchAndPrice.hasSolution() ? (result.objective - result.bound) / result.objective : GRB_INFINITY;
+        result.runtime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (branchAndPrice.hasSolution()) {
+            printSolution(branchAndPrice.getSolution(), closed);
+        }
+        return;
+    }
+
+    if (params.formulation == VrptwFormulation::Decomposition) {
+        auto start = std::chrono::steady_clock::now();
+        VrptwSolution solution = clusterDecomposition(instance, heuristicSolution, timeLimit);
+
+        // No solution found is no proof of infeasibility.
+        bool found = !solution.routes.empty();
+        result.status = GRB_TIME_LIMIT;
+        result.solutionCount = found ? 1 : 0;
+        result.objective = solution.cost;
+        result.gap = GRB_INFINITY;
+        result.runtime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (found) {
+            printSolution(solution, false);
+        }
+        return;
+    }
 
     // ------ Gurobi model. ---------------
-    GRBEnv *env = new GRBEnv();
-    GRBModel model = GRBModel(*env);
-    model.set(GRB_IntAttr_ModelSense, GRB_MINIMIZE);
-    model.set(GRB_StringAttr_ModelName, "VRP-TW ILP model");
-    model.set(GRB_DoubleParam_TimeLimit, timeLimit);
+    // Granular mode solves on the k best arcs per customer first, k doubles while the restricted model is infeasible.
+    auto start = std::chrono::steady_clock::now();
+    int neighbours = params.granularNeighbours;
+    while (true) {
+        const bool granular = neighbours > 0 && neighbours < instance.numberOfNodes;
+        VrptwArcSet modelArcs = granular ? VrptwPreprocessing::granularArcs(instance, arcSet, neighbours, heuristicSolution) : arcSet;
+        if (granular) {
+            cout << "Granular arc set (k = " << neighbours << "): " << modelArcs.arcs.size() << " arcs." << endl;
+        }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        GRBModel model = GRBModel(getEnv());
+        model.set(GRB_IntParam_Threads, threads);
+        model.set(GRB_IntAttr_ModelSense, GRB_MINIMIZE);
+        model.set(GRB_StringAttr_ModelName, "VRP-TW ILP model");
+        model.set(GRB_DoubleParam_TimeLimit, std::max(0.0, timeLimit - elapsed));
+
+        VrptwSolution solution;
+        switch (params.formulation) {
+        case VrptwFormulation::TwoIndex:
+            solution = twoIndexVehicleFlowFormulation(model, instance, modelArcs, heuristicSolution);
+            break;
+        case VrptwFormulation::ThreeIndex:
+            solution = threeIndexVehicleFlowFormulation(model, instance, modelArcs, heuristicSolution);
+            break;
+        case VrptwFormulation::BranchAndPrice:
+        case VrptwFormulation::Alns:
+        case VrptwFormulation::Decomposition:
+            break; // solved above without a compact model
+        }
 
+        const int status = model.get(GRB_IntAttr_Status);
+        if (modelArcs.arcs.size() < arcSet.arcs.size() && (status == GRB_INFEASIBLE || status == GRB_INF_OR_UNBD)) {
+            cout << "Granular model infeasible, re-adding arcs." << endl;
+            neighbours *= 2;
+            continue;
+        }
 
+        recordResult(model);
+        result.runtime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        // Status, bound and gap of a restricted arc set prove nothing for the instance.
+        const bool restricted = modelArcs.arcs.size() < arcSet.arcs.size();
+        if (restricted) {
+            result.status = GRB_TIME_LIMIT;
+            result.bound = 0;
+            result.gap = GRB_INFINITY;
+        }
+
+        if (model.get(GRB_IntAttr_SolCount) > 0) {
+            printSolution(solution, status == GRB_OPTIMAL && !restricted);
+        }
+        else if (status == GRB_INFEASIBLE) {
+            model.computeIIS();
+            model.write("vrptw_model_IIS.ilp");
+        }
+        break;
+    }
+
+}
+
+
+VrptwSolution VrptwMIP::twoIndexVehicleFlowFormulation(GRBModel& model, const VrptwInstance& instance, const VrptwArcSet& arcSet,
+                                                       const VrptwSolution& heuristicSolution) {
+    /// MIP two-index flow formulation for C-VRP-TW, as in https://arxiv.org/pdf/1606.01935.pdf, pg.4, equations (2.1)-(2.9).
+    /// Variables and constraints are built only for the arcs kept by VrptwPreprocessing::feasibleArcs.
+
+    const int numberOfNodes = instance.numberOfNodes;
+    const int vehicleCapacity = instance.vehicleCapacity;
+    const DistanceMatrix& distanceMatrix = instance.distanceMatrix;
+    const vector<int>& demands = instance.demands;
+    const vector<pair<int, int>>& timeWindows = instance.timeWindows;
+    const int numberOfArcs = (int)arcSet.arcs.size();
+
+    ModelBuilder builder(model);
 
     // ------ Variables. ---------------
-    GRBVar** x = new GRBVar* [numberOfNodes + 1]; // binary, x_ij == 1 iff route goes from i->j
+    vector<int> xIdx(numberOfArcs); // binary, x_a == 1 iff route uses arc a = (i, j)
+    for (int a = 0; a < numberOfArcs; ++a) {
+        const int i = arcSet.arcs[a].first, j = arcSet.arcs[a].second;
+        int objCoeffs = distanceMatrix[i % numberOfNodes][j % numberOfNodes];
+        xIdx[a] = builder.queueVar(0, 1, objCoeffs, GRB_BINARY,
+                                   [&] { return "x_" + std::to_string(i) + "_" + std::to_string(j); });
+    }
+
+    vector<int> yIdx(numberOfNodes + 1);
     for (int i = 0; i < numberOfNodes + 1; ++i) {
-        x[i] = new GRBVar[numberOfNodes + 1];
-        for (int j = 0; j < numberOfNodes + 1; ++j) {
-            string name = "x_" + std::to_string(i) + std::to_string(j);
-            int objCoeffs = distanceMatrix[i % numberOfNodes][j % numberOfNodes];
-            x[i][j] = model.addVar(0, 1, objCoeffs, GRB_BINARY, name);
-        }
+        yIdx[i] = builder.queueVar(demands[i % numberOfNodes], (i == 0) ? 0 : vehicleCapacity, 0, GRB_CONTINUOUS,
+                                   [&] { return "y_i" + std::to_string(i); });
     }
 
-    GRBVar* y = new GRBVar[numberOfNodes ];
+    vector<int> wIdx(numberOfNodes + 1);
     for (int i = 0; i < numberOfNodes + 1; ++i) {
-        std::string name = "y_i" + std::to_string(i);
-        y[i] = model.addVar(demands[i % numberOfNodes], vehicleCapacity, 0, GRB_CONTINUOUS, name);
+        // Vehicles leave the start depot at a_0, waiting happens at the customers.
+        int latest = (i == 0) ? timeWindows[0].first : timeWindows[i % numberOfNodes].second;
+        wIdx[i] = builder.queueVar(timeWindows[i % numberOfNodes].first, latest, 0, GRB_CONTINUOUS,
+                                   [&] { return "w" + std::to_string(i); });
     }
 
+    GRBVar* vars = builder.addQueuedVars();
+
+    GRBVar* x = new GRBVar[numberOfArcs];
+    GRBVar* y = new GRBVar[numberOfNodes + 1];
     GRBVar* w = new GRBVar[numberOfNodes + 1];
+    for (int a = 0; a < numberOfArcs; ++a) {
+        x[a] = vars[xIdx[a]];
+    }
     for (int i = 0; i < numberOfNodes + 1; ++i) {
-        std::string name = "w" + std::to_string(i);
-        w[i] = model.addVar(timeWindows[i % numberOfNodes].first, timeWindows[i % numberOfNodes].second, 0, GRB_CONTINUOUS, name);
+        y[i] = vars[yIdx[i]];
+        w[i] = vars[wIdx[i]];
     }
+    delete[] vars;
 
     // ------ Constraints. ---------------
 
     for (int i = 1; i < numberOfNodes; ++i) {
         GRBLinExpr expr = 0;
-        for (int j = 1; j < numberOfNodes + 1; ++j) {
-            if (i == j) {continue;}
-            expr += x[i][j];
+        for (int a : arcSet.outgoing[i]) {
+            expr += x[a];
         }
-        std::string name = "leaving node " + std::to_string(i) + " once.";
-        model.addConstr(expr == 1, name);
+        builder.queueConstr(std::move(expr), GRB_EQUAL, 1, [&] { return "leaving node " + std::to_string(i) + " once."; });
     }
 
-    GRBLinExpr expr1;
-    GRBLinExpr expr2;
     for (int h = 1; h < numberOfNodes; ++h) {
-        expr1 = 0;
-        expr2 = 0;
-        for (int i = 0; i < numberOfNodes; ++i) {
-            if (i == h) {continue;}
-            expr1 += x[i][h];
+        GRBLinExpr expr = 0;
+        for (int a : arcSet.incoming[h]) {
+            expr += x[a];
         }
-        for (int j = 1; j < numberOfNodes + 1; ++j) {
-            if (j == h) {continue;}
-            expr2 += x[h][j];
+        for (int a : arcSet.outgoing[h]) {
+            expr -= x[a];
         }
-        string name = "number of vehicles arriving and leaving node " + std::to_string(h) + " equals";
-        model.addConstr(expr1 == expr2, name);
+        builder.queueConstr(std::move(expr), GRB_EQUAL, 0,
+                            [&] { return "number of vehicles arriving and leaving node " + std::to_string(h) + " equals"; });
     }
 
     GRBLinExpr expr = 0;
-    for (int j = 1; j < numberOfNodes; ++j) {
-        expr += x[0][j];
+    for (int a : arcSet.outgoing[0]) {
+        expr += x[a];
     }
-    model.addConstr(expr <= fleetSize, "number of vehicles leaving depot.");
-    
-    for (int i = 0; i < numberOfNodes + 1; ++i) {
-        for (int j = 0; j < numberOfNodes + 1; ++j) {
-            model.addConstr(y[j] >= y[i] + demands[j % numberOfNodes] * x[i][j] - vehicleCapacity * (1 - x[i][j]));
-        }
+    builder.queueConstr(std::move(expr), GRB_LESS_EQUAL, instance.fleetSize, [] { return string("number of vehicles leaving depot."); });
+
+    // y_j >= y_i + d_j x_ij - M_ij (1 - x_ij), M_ij = Q - d_j
+    for (int a = 0; a < numberOfArcs; ++a) {
+        auto [i, j] = arcSet.arcs[a];
+        int bigM = VrptwPreprocessing::loadBigM(instance, i, j);
+        builder.queueConstr(y[j] - y[i] - (demands[j % numberOfNodes] + bigM) * x[a], GRB_GREATER_EQUAL, -bigM);
     }
 
-    // todo: bigM large enough scalar?
-    //vector<vector<int>> bigM;
-    //bigM.reserve((numberOfNodes + 1) * (numberOfNodes + 1));
-    //for (int i = 0; i < numberOfNodes + 1; ++i) {
-    //    for (int j = 0; j < numberOfNodes + 1; ++j) {
-    //        bigM.emplace_back(std::max(0, timeWindows[i].second - timeWindows[j].first));
-    //    }
-    //}
+    // w_j >= w_i + s_i + t_ij - M_ij (1 - x_ij), M_ij = max(0, b_i + s_i + t_ij - a_j)
+    for (int a = 0; a < numberOfArcs; ++a) {
+        auto [i, j] = arcSet.arcs[a];
+        int travelTime = instance.serviceTimes[i % numberOfNodes] + distanceMatrix[i % numberOfNodes][j % numberOfNodes];
+        int bigM = VrptwPreprocessing::timeBigM(instance, i, j);
+        builder.queueConstr(w[j] - w[i] - bigM * x[a], GRB_GREATER_EQUAL, travelTime - bigM);
+    }
 
-    int bigM = 100000;
-    for (int i = 0; i < numberOfNodes; ++i) {
-        for (int j = 1; j < numberOfNodes + 1; ++j) {
-            model.addConstr(w[j] >= w[i] + demands[j % numberOfNodes] * x[i][j] - bigM * (1 - x[i][j]));
+    builder.addQueuedConstrs();
+
+
+    //------- MIP start from the insertion heuristic. -----------
+    if (!heuristicSolution.routes.empty()) {
+        vector<double> xStart(numberOfArcs, 0);
+        for (const VrptwRoute& route : heuristicSolution.routes) {
+            for (int a : arcSet.routeArcs(route.customers)) {
+                xStart[a] = 1;
+            }
+            int load = 0, time = timeWindows[0].first, previous = 0;
+            for (int customer : route.customers) {
+                load += demands[customer];
+                time = std::max(timeWindows[customer].first,
+                                time + instance.serviceTimes[previous] + distanceMatrix[previous][customer]);
+                y[customer].set(GRB_DoubleAttr_Start, load);
+                w[customer].set(GRB_DoubleAttr_Start, time);
+                previous = customer;
+            }
         }
+        model.set(GRB_DoubleAttr_Start, x, xStart.data(), numberOfArcs);
+        y[0].set(GRB_DoubleAttr_Start, 0);
+        w[0].set(GRB_DoubleAttr_Start, timeWindows[0].first);
+    }
+
+
+    //------- Capacity cuts separated in the callback. -----------
+    VrptwCallback callback(instance, arcSet, x, params.maxCutsPerNode);
+    if (params.capacityCuts) {
+        model.set(GRB_IntParam_PreCrush, 1);
+        model.setCallback(&callback);
     }
 
 
+    //------- Solve the model. -----------
     model.optimize();
 
-    if (model.get(GRB_IntAttr_Status) == GRB_OPTIMAL) {
-        cout << "\n==================================" << endl;
-        cout << "tour cost: " << model.get(GRB_DoubleAttr_ObjVal) << endl;
-
-        //for (int i = 0; i < numberOfNodes+1; i++) {
-        //    for (int j = 0; j < numberOfNodes + 1; j++) {
-        //        cout << x[i][j].get(GRB_DoubleAttr_X) << " ";
-        //    }
-        //    cout << endl;
-        //}
-        cout << "==================================\n";
-    }
-    else {
-        model.computeIIS();
-        model.write("vrptw_model_IIS.ilp");
-    }
-
-    // Print the objective
-    // and the values of the decision variables in the solution.
-//    std::cout << "Optimal objective: " << model.get(GRB_DoubleAttr_ObjVal) << std::endl;
-//    std::cout << "x: " << x.get(GRB_DoubleAttr_X) << " ";
-//    std::cout << "y: " << y.get(GRB_DoubleAttr_X) << std::endl;
-//    std::cout << "w: " << y.get(GRB_DoubleAttr_X) << std::endl;
+    if (params.capacityCuts) {
+        cout << "rounded capacity cuts: " << callback.getNumberOfCuts() << endl;
+    }
+
+    VrptwSolution solution;
+    if (model.get(GRB_IntAttr_SolCount) > 0) {
+        double* xValues = model.get(GRB_DoubleAttr_X, x, numberOfArcs);
+        solution = readRoutes(instance, arcSet, vector<double>(xValues, xValues + numberOfArcs));
+        delete[] xValues;
+    }
+
+    delete[] x;
+    delete[] y;
+    delete[] w;
+    return solution;
+}
+
+
+VrptwSolution VrptwMIP::clusterDecomposition(const VrptwInstance& instance, const VrptwSolution& heuristicSolution, float timeLimit) {
+    auto start = std::chrono::steady_clock::now();
+
+    const vector<vector<int>> clusters = VrptwDecomposition::clusterCustomers(instance, params.clusterSize);
+    const int totalThreads = threads > 0 ? threads : std::max(1, (int)std::thread::hardware_concurrency());
+    const int workers = std::max(1, std::min((int)clusters.size(),
+                                             params.decompositionWorkers > 0 ? params.decompositionWorkers : totalThreads));
+    const int threadsPerWorker = std::max(1, totalThreads / workers);
+    const int rounds = ((int)clusters.size() + workers - 1) / workers;
+    const double clusterTimeLimit = clusterTimeShare * timeLimit / rounds;
+    cout << "Decomposition: " << clusters.size() << " clusters on " << workers << " workers, "
+         << clusterTimeLimit << " s per cluster." << endl;
+
+    // ------ Route pool shared by the workers. ---------------
+    std::mutex poolMutex;
+    vector<VrptwRoute> pool;
+    std::set<vector<int>> pooled;
+    auto addRoute = [&](vector<int>&& customers) {
+        if (!routeFeasible(instance, customers)) {return;}
+        std::lock_guard<std::mutex> lock(poolMutex);
+        if (pooled.insert(customers).second) {
+            pool.push_back({ customers, routeCost(instance, customers) });
+        }
+    };
+    for (const VrptwRoute& route : heuristicSolution.routes) {
+        addRoute(vector<int>(route.customers));
+    }
+
+    // Best routes of every cluster, combined into the set partitioning start.
+    vector<VrptwSolution> clusterSolutions(clusters.size());
+
+    // Read once here, the caller's environment is not shared with the worker threads.
+    GRBEnv& callerEnv = getEnv();
+    vector<pair<GRB_StringParam, std::string>> stringParams;
+    for (GRB_StringParam param : connectionStringParams) {
+        stringParams.emplace_back(param, callerEnv.get(param));
+    }
+    vector<pair<GRB_IntParam, int>> intParams;
+    for (GRB_IntParam param : connectionIntParams) {
+        intParams.emplace_back(param, callerEnv.get(param));
+    }
+    auto remaining = [&]() {
+        return std::max(0.0, timeLimit - std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    };
+
+    std::atomic<size_t> nextCluster(0);
+    std::exception_ptr failure;
+    auto worker = [&]() {
+        try {
+            GRBEnv env(true);
+            for (const auto& param : stringParams) {
+                env.set(param.first, param.second);
+            }
+            for (const auto& param : intParams) {
+                env.set(param.first, param.second);
+            }
+            env.set(GRB_IntParam_OutputFlag, 0);
+            env.start();
+
+            for (size_t c; (c = nextCluster++) < clusters.size();) {
+                const vector<int>& customers = clusters[c];
+                VrptwInstance sub = VrptwDecomposition::subInstance(instance, customers);
+                VrptwArcSet subArcs = VrptwPreprocessing::feasibleArcs(sub);
+                VrptwSolution subStart = VrptwHeuristics::bestInsertionSolution(sub, threadsPerWorker);
+
+                GRBModel model = GRBModel(env);
+                model.set(GRB_IntParam_Threads, threadsPerWorker);
+                model.set(GRB_IntAttr_ModelSense, GRB_MINIMIZE);
+                model.set(GRB_StringAttr_ModelName, "VRP-TW cluster " + std::to_string(c));
+                model.set(GRB_DoubleParam_TimeLimit, std::min(clusterTimeLimit, remaining()));
+                VrptwSolution subSolution = twoIndexVehicleFlowFormulation(model, sub, subArcs, subStart);
+
+                VrptwSolution& best = clusterSolutions[c];
+                for (const VrptwSolution* solution : { &subStart, &subSolution }) {
+                    VrptwSolution global;
+                    for (const VrptwRoute& route : solution->routes) {
+                        vector<int> globalCustomers;
+                        for (int local : route.customers) {
+                            globalCustomers.push_back(customers[local - 1]);
+                        }
+                        global.routes.push_back({ globalCustomers, route.cost });
+                        global.cost += route.cost;
+                        addRoute(std::move(globalCustomers));
+                    }
+                    if (!global.routes.empty() && (best.routes.empty() || global.cost < best.cost)) {
+                        best = std::move(global);
+                    }
+                }
+            }
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(poolMutex);
+            if (!failure) {failure = std::current_exception();}
+            nextCluster = clusters.size();
+        }
+    };
+
+    vector<std::thread> workerThreads;
+    for (int k = 0; k < workers; ++k) {
+        workerThreads.emplace_back(worker);
+    }
+    for (auto& thread : workerThreads) {
+        thread.join();
+    }
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+
+    // ------ Set partitioning over the pool. ---------------
+    VrptwSolution combined;
+    for (const VrptwSolution& clusterSolution : clusterSolutions) {
+        if (clusterSolution.routes.empty()) {
+            combined = VrptwSolution();
+            break;
+        }
+        combined.routes.insert(combined.routes.end(), clusterSolution.routes.begin(), clusterSolution.routes.end());
+        combined.cost += clusterSolution.cost;
+    }
+    const VrptwSolution& spStart = (!combined.routes.empty() && (int)combined.routes.size() <= instance.fleetSize
+                                    && (heuristicSolution.routes.empty() || combined.cost < heuristicSolution.cost))
+                                   ? combined : heuristicSolution;
+
+    cout << "Set partitioning over " << pool.size() << " routes." << endl;
+    return VrptwDecomposition::setPartitioning(callerEnv, threads, instance, pool, spStart, remaining());
 }
 
 
-void VrptwMIP::threeIndexVehicleFlowFormulation(int numberOfNodes, int vehicleCapacity, int fleetSize,
-                                                vector<vector<int>> distanceMatrix,
-                                                vector<int> demands,
-                                                vector<pair<int, int>> timeWindows,
-                                                float timeLimit) {
-    /// as given in https://reader.elsevier.com/reader/sd/pii/S1018364710000297?token=9FADA6554ECCE12A5E12D35BD4A5B2ADD681E2213839F403847CB643836E778BF8671D023E24E2EF5CA3BB97BA423623&originRegion=eu-west-1&originCreation=20220114122755
+VrptwSolution VrptwMIP::threeIndexVehicleFlowFormulation(GRBModel& model, const VrptwInstance& instance, const VrptwArcSet& arcSet,
+                                                         const VrptwSolution& heuristicSolution) {
+    /// Three-index vehicle flow formulation, as given in https://reader.elsevier.com/reader/sd/pii/S1018364710000297?token=9FADA6554ECCE12A5E12D35BD4A5B2ADD681E2213839F403847CB643836E778BF8671D023E24E2EF5CA3BB97BA423623&originRegion=eu-west-1&originCreation=20220114122755
+    /// x_ijk per vehicle k and feasible arc, v_ik == 1 iff vehicle k serves customer i, w_ik = service start of k at i.
+    /// Symmetry breaking (Fischetti et al.): vehicle k serves only customers i >= k+1, and the lowest customer
+    /// of vehicle k is larger than the lowest customer of vehicle k-1.
+
+    const int numberOfNodes = instance.numberOfNodes;
+    const int fleetSize = instance.fleetSize;
+    const DistanceMatrix& distanceMatrix = instance.distanceMatrix;
+    const vector<pair<int, int>>& timeWindows = instance.timeWindows;
+    const int numberOfArcs = (int)arcSet.arcs.size();
+
+    // Vehicle k may serve customer i (1..N-1).
+    auto allowed = [&](int i, int k) {
+        return !params.symmetryBreaking || k < i;
+    };
+    // Vehicle k may use arc (i, j), the depot copies 0 and N are open to every vehicle.
+    auto arcAllowed = [&](int i, int j, int k) {
+        return (i == 0 || allowed(i, k)) && (j == numberOfNodes || allowed(j, k));
+    };
 
+    ModelBuilder builder(model);
+
+    // ------ Variables. ---------------
+    vector<vector<int>> xIdx(fleetSize, vector<int>(numberOfArcs, -1)); // binary, x[k][a] == 1 iff vehicle k uses arc a
+    for (int k = 0; k < fleetSize; ++k) {
+        for (int a = 0; a < numberOfArcs; ++a) {
+            const int i = arcSet.arcs[a].first, j = arcSet.arcs[a].second;
+            if (!arcAllowed(i, j, k)) {continue;}
+            int objCoeffs = distanceMatrix[i % numberOfNodes][j % numberOfNodes];
+            xIdx[k][a] = builder.queueVar(0, 1, objCoeffs, GRB_BINARY, [&] {
+                return "x_" + std::to_string(i) + "_" + std::to_string(j) + "_" + std::to_string(k); });
+        }
+    }
+
+    vector<vector<int>> vIdx(fleetSize, vector<int>(numberOfNodes, -1)); // v[k][i] == 1 iff vehicle k serves customer i, continuous, fixed by the arcs
+    for (int k = 0; k < fleetSize; ++k) {
+        for (int i = 1; i < numberOfNodes; ++i) {
+            if (!allowed(i, k)) {continue;}
+            vIdx[k][i] = builder.queueVar(0, 1, 0, GRB_CONTINUOUS,
+                                          [&] { return "v_" + std::to_string(i) + "_" + std::to_string(k); });
+        }
+    }
+
+    vector<vector<int>> wIdx(fleetSize, vector<int>(numberOfNodes + 1)); // w[k][i] = service start of vehicle k at node i
+    for (int k = 0; k < fleetSize; ++k) {
+        for (int i = 0; i < numberOfNodes + 1; ++i) {
+            int latest = (i == 0) ? timeWindows[0].first : timeWindows[i % numberOfNodes].second;
+            wIdx[k][i] = builder.queueVar(timeWindows[i % numberOfNodes].first, latest, 0, GRB_CONTINUOUS,
+                                          [&] { return "w_" + std::to_string(i) + "_" + std::to_string(k); });
+        }
+    }
+
+    GRBVar* vars = builder.addQueuedVars();
+
+    GRBVar** x = new GRBVar* [fleetSize];
+    GRBVar** v = new GRBVar* [fleetSize];
+    GRBVar** w = new GRBVar* [fleetSize];
+    for (int k = 0; k < fleetSize; ++k) {
+        x[k] = new GRBVar[numberOfArcs];
+        v[k] = new GRBVar[numberOfNodes];
+        w[k] = new GRBVar[numberOfNodes + 1];
+        for (int a = 0; a < numberOfArcs; ++a) {
+            if (xIdx[k][a] >= 0) {x[k][a] = vars[xIdx[k][a]];}
+        }
+        for (int i = 1; i < numberOfNodes; ++i) {
+            if (vIdx[k][i] >= 0) {v[k][i] = vars[vIdx[k][i]];}
+        }
+        for (int i = 0; i < numberOfNodes + 1; ++i) {
+            w[k][i] = vars[wIdx[k][i]];
+        }
+    }
+    delete[] vars;
+
+    // ------ Constraints. ---------------
+
+    for (int i = 1; i < numberOfNodes; ++i) {
+        GRBLinExpr expr = 0;
+        for (int k = 0; k < fleetSize; ++k) {
+            if (vIdx[k][i] >= 0) {expr += v[k][i];}
+        }
+        builder.queueConstr(std::move(expr), GRB_EQUAL, 1, [&] { return "customer " + std::to_string(i) + " served once."; });
+    }
+
+    for (int k = 0; k < fleetSize; ++k) {
+        // v_ik = sum_j x_ijk and flow conservation at every customer.
+        for (int i = 1; i < numberOfNodes; ++i) {
+            if (vIdx[k][i] < 0) {continue;}
+            GRBLinExpr leaving = 0, arriving = 0;
+            for (int a : arcSet.outgoing[i]) {
+                if (xIdx[k][a] >= 0) {leaving += x[k][a];}
+            }
+            for (int a : arcSet.incoming[i]) {
+                if (xIdx[k][a] >= 0) {arriving += x[k][a];}
+            }
+            builder.queueConstr(leaving - v[k][i], GRB_EQUAL, 0);
+            builder.queueConstr(arriving - v[k][i], GRB_EQUAL, 0);
+        }
+
+        GRBLinExpr depart = 0;
+        for (int a : arcSet.outgoing[0]) {
+            if (xIdx[k][a] >= 0) {depart += x[k][a];}
+        }
+        builder.queueConstr(std::move(depart), GRB_LESS_EQUAL, 1, [&] { return "vehicle " + std::to_string(k) + " leaves depot once."; });
+
+        GRBLinExpr load = 0;
+        for (int i = 1; i < numberOfNodes; ++i) {
+            if (vIdx[k][i] >= 0) {load += instance.demands[i] * v[k][i];}
+        }
+        builder.queueConstr(std::move(load), GRB_LESS_EQUAL, instance.vehicleCapacity,
+                            [&] { return "capacity of vehicle " + std::to_string(k); });
+
+        // w_jk >= w_ik + s_i + t_ij - M_ij (1 - x_ijk)
+        for (int a = 0; a < numberOfArcs; ++a) {
+            if (xIdx[k][a] < 0) {continue;}
+            const int i = arcSet.arcs[a].first, j = arcSet.arcs[a].second;
+            int travelTime = instance.serviceTimes[i % numberOfNodes] + distanceMatrix[i % numberOfNodes][j % numberOfNodes];
+            int bigM = VrptwPreprocessing::timeBigM(instance, i, j);
+            builder.queueConstr(w[k][j] - w[k][i] - bigM * x[k][a], GRB_GREATER_EQUAL, travelTime - bigM);
+        }
+    }
+
+    if (params.symmetryBreaking) {
+        for (int k = 1; k < fleetSize; ++k) {
+            // Vehicle k is used only if vehicle k-1 is.
+            GRBLinExpr used = 0;
+            for (int a : arcSet.outgoing[0]) {
+                if (xIdx[k][a] >= 0) {used += x[k][a];}
+                if (xIdx[k - 1][a] >= 0) {used -= x[k - 1][a];}
+            }
+            builder.queueConstr(std::move(used), GRB_LESS_EQUAL, 0);
+
+            // v_ik <= sum_{h = k}^{i-1} v_h,k-1 : vehicle k-1 serves a customer below i.
+            GRBLinExpr lowerCustomers = 0;
+            for (int i = k + 1; i < numberOfNodes; ++i) {
+                lowerCustomers += v[k - 1][i - 1];
+                builder.queueConstr(v[k][i] - lowerCustomers, GRB_LESS_EQUAL, 0);
+            }
+        }
+    }
+
+    builder.addQueuedConstrs();
+
+
+    //------- MIP start from the insertion heuristic. -----------
+    // Routes sorted by lowest customer satisfy the symmetry breaking rows when assigned to vehicles in that order.
+    if (!heuristicSolution.routes.empty()) {
+        vector<const VrptwRoute*> routes;
+        for (const VrptwRoute& route : heuristicSolution.routes) {
+            routes.push_back(&route);
+        }
+        std::sort(routes.begin(), routes.end(), [](const VrptwRoute* a, const VrptwRoute* b) {
+            return *std::min_element(a->customers.begin(), a->customers.end())
+                 < *std::min_element(b->customers.begin(), b->customers.end());
+        });
+
+        for (int k = 0; k < fleetSize; ++k) {
+            vector<double> xStart(numberOfArcs, 0);
+            if (k < (int)routes.size()) {
+                for (int a : arcSet.routeArcs(routes[k]->customers)) {
+                    xStart[a] = 1;
+                }
+                int time = timeWindows[0].first, previous = 0;
+                for (int customer : routes[k]->customers) {
+                    time = std::max(timeWindows[customer].first,
+                                    time + instance.serviceTimes[previous] + distanceMatrix[previous][customer]);
+                    w[k][customer].set(GRB_DoubleAttr_Start, time);
+                    previous = customer;
+                }
+            }
+            for (int a = 0; a < numberOfArcs; ++a) {
+                if (xIdx[k][a] >= 0) {x[k][a].set(GRB_DoubleAttr_Start, xStart[a]);}
+            }
+            for (int i = 1; i < numberOfNodes; ++i) {
+                if (vIdx[k][i] < 0) {continue;}
+                bool served = k < (int)routes.size()
+                    && std::find(routes[k]->customers.begin(), routes[k]->customers.end(), i) != routes[k]->customers.end();
+                v[k][i].set(GRB_DoubleAttr_Start, served ? 1 : 0);
+            }
+        }
+    }
+
+
+    //------- Solve the model. -----------
+    model.optimize();
+
+    VrptwSolution solution;
+    if (model.get(GRB_IntAttr_SolCount) > 0) {
+        for (int k = 0; k < fleetSize; ++k) {
+            vector<double> arcValues(numberOfArcs, 0);
+            for (int a = 0; a < numberOfArcs; ++a) {
+                if (xIdx[k][a] >= 0) {arcValues[a] = x[k][a].get(GRB_DoubleAttr_X);}
+            }
+            VrptwSolution vehicleRoutes = readRoutes(instance, arcSet, arcValues);
+            for (VrptwRoute& route : vehicleRoutes.routes) {
+                solution.cost += route.cost;
+                solution.routes.push_back(std::move(route));
+            }
+        }
+    }
+
+    for (int k = 0; k < fleetSize; ++k) {
+        delete[] x[k];
+        delete[] v[k];
+        delete[] w[k];
+    }
+    delete[] x;
+    delete[] v;
+    delete[] w;
+    return solution;
 }
 
 
-// ILP formulation cubic in variables, not used.
+// Notes for the formulations, the arc rules are applied in VrptwPreprocessing::feasibleArcs.
 // arc set:
 // (0, i);
 // (i, j): 1) a_i + t_ij <= b_j , t_ij= time from i->j + serviceTime_i , (i, n+1)
@@ -8,22 +8,59 @@
 using std::vector;
 using std::pair;
 
+class GRBModel;
+struct VrptwInstance;
+struct VrptwArcSet;
+struct VrptwSolution;
+
+enum class VrptwFormulation {
+    TwoIndex,  // one arc binary shared by all vehicles, load and time variables per node
+    ThreeIndex,    // arc binaries, assignment and time variables per vehicle
+    BranchAndPrice, // set covering master over routes, ng-route labeling pricing, arc flow branching
+    Alns,           // adaptive large neighbourhood search only, no lower bound
+    Decomposition   // cluster-first route-second: two-index MIP per cluster in parallel, set partitioning over their routes
+};
+
+
+struct VrptwMIPParams {
+    /// <summary>
+    /// Formulation switches of the VRPTW MIP model.
+    /// </summary>
+    VrptwFormulation formulation = VrptwFormulation::TwoIndex;
+    bool tightenTimeWindows = true; // Desrochers-style window reduction before the arcs are built
+    bool warmStart = true;        // load the best Solomon I1 solution as MIP start / first incumbent
+    bool symmetryBreaking = true; // three-index only: vehicle k serves customers >= k+1, vehicles ordered by lowest customer
+    bool capacityCuts = true;     // two-index only: separate rounded capacity cuts at the MIP nodes
+    int maxCutsPerNode = 20;
+    int ngSize = 8;                 // branch-and-price: ng-neighbourhood size of the pricing, at most 64
+    int columnsPerPricing = 100;    // branch-and-price: routes added per pricing round
+    double alnsTimeLimit = 0;       // seconds of ALNS improving the warm start before the exact model, 0 = none
+    int granularNeighbours = 0;     // compact models: keep the arcs to the k best neighbours per customer, 0 = all arcs.
+                                    // Optimality is then relative to the kept arcs.
+    int clusterSize = 25;           // decomposition: target customers per cluster
+    int decompositionWorkers = 0;   // decomposition: clusters solved at once, 0 = one per thread
+};
+
 class VrptwMIP : public ModelMIP  {
 private:
-    void twoIndexVehicleFlowFormulation(int numberOfNodes, int vehicleCapacity, int fleetSize, 
-                                        vector<vector<int>> distanceMatrix,
-                                        vector<int> demands, 
-                                        vector<pair<int, int>> timeWindows, 
-                                        float timeLimit);
-
-    void threeIndexVehicleFlowFormulation(int numberOfNodes, int vehicleCapacity, int fleetSize,
-                                          vector<vector<int>> distanceMatrix,
-                                          vector<int> demands,
-                                          vector<pair<int, int>> timeWindows,
-                                          float timeLimit);
+    VrptwMIPParams params;
+
+    // Each formulation builds, warm starts and solves the model on the feasible arcs of arcSet,
+    // returns the incumbent routes (empty if none).
+    VrptwSolution twoIndexVehicleFlowFormulation(GRBModel& model, const VrptwInstance& instance, const VrptwArcSet& arcSet,
+                                                 const VrptwSolution& heuristicSolution);
+
+    VrptwSolution threeIndexVehicleFlowFormulation(GRBModel& model, const VrptwInstance& instance, const VrptwArcSet& arcSet,
+                                                   const VrptwSolution& heuristicSolution);
+
+    // Solves the two-index model of every cluster on worker threads with their own environments,
+    // then set partitioning over the pool of cluster and heuristic routes. Empty solution if none is found.
+    VrptwSolution clusterDecomposition(const VrptwInstance& instance, const VrptwSolution& heuristicSolution, float timeLimit);
 
 public:
+    VrptwMIP() = default;
+    explicit VrptwMIP(const VrptwMIPParams& params) : params(params) {}
+
     void solveInstance(const char* instancePath, float timeLimit);
 
 };
-
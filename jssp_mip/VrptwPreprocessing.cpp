@@ -0,0 +1,178 @@
+#pragma once
+
+#include "VrptwPreprocessing.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+int VrptwPreprocessing::tightenTimeWindows(VrptwInstance& instance) {
+    const int N = instance.numberOfNodes;
+    const auto& t = instance.distanceMatrix;
+    const auto& s = instance.serviceTimes;
+    const auto& d = instance.demands;
+    auto& tw = instance.timeWindows;
+
+    // Reaching k from the depot and returning in time.
+    for (int k = 1; k < N; ++k) {
+        long long arrival = std::max((long long)tw[k].first, (long long)tw[0].first + t[0][k]);
+        if (arrival > tw[k].second || arrival + s[k] + t[k][0] > tw[0].second) {
+            throw std::runtime_error("Customer " + std::to_string(k) + " cannot be served within its time window.");
+        }
+    }
+
+    // Node i can directly precede node j (depot 0 on both sides).
+    auto canPrecede = [&](int i, int j) {
+        return i != j && d[i] + d[j] <= instance.vehicleCapacity
+            && (long long)tw[i].first + s[i] + t[i][j] <= tw[j].second;
+    };
+
+    std::vector<char> tightened(N, 0);
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int k = 1; k < N; ++k) {
+            // The depot is a predecessor (vehicles leave at a_0) and a successor (open until b_0).
+            long long earliestArrival = (long long)tw[0].first + t[0][k], latestArrival = earliestArrival;
+            long long earliestDeparture = (long long)tw[0].first - s[k] - t[k][0];
+            long long latestDeparture = (long long)tw[0].second - s[k] - t[k][0];
+            for (int i = 1; i < N; ++i) {
+                if (canPrecede(i, k)) {
+                    earliestArrival = std::min(earliestArrival, (long long)tw[i].first + s[i] + t[i][k]);
+                    latestArrival = std::max(latestArrival, (long long)tw[i].second + s[i] + t[i][k]);
+                }
+            }
+            for (int j = 1; j < N; ++j) {
+                if (canPrecede(k, j)) {
+                    earliestDeparture = std::min(earliestDeparture, (long long)tw[j].first - s[k] - t[k][j]);
+                    latestDeparture = std::max(latestDeparture, (long long)tw[j].second - s[k] - t[k][j]);
+                }
+            }
+
+            long long start = std::max({ (long long)tw[k].first, std::min((long long)tw[k].second, earliestArrival),
+                                         std::min((long long)tw[k].second, earliestDeparture) });
+            long long end = std::min({ (long long)tw[k].second, std::max(start, latestArrival), std::max(start, latestDeparture) });
+            if (start != tw[k].first || end != tw[k].second) {
+                tw[k] = { (int)start, (int)end };
+                tightened[k] = 1;
+                changed = true;
+            }
+        }
+    }
+
+    return (int)std::count(tightened.begin(), tightened.end(), 1);
+}
+
+VrptwArcSet VrptwPreprocessing::feasibleArcs(const VrptwInstance& instance) {
+    const int N = instance.numberOfNodes;
+
+    VrptwArcSet arcSet;
+    arcSet.outgoing.resize(N + 1);
+    arcSet.incoming.resize(N + 1);
+    arcSet.arcIndex.assign(N + 1, std::vector<int>(N + 1, -1));
+
+    for (int i = 0; i < N; ++i) {
+        for (int j = 1; j < N + 1; ++j) {
+            if (i == j || (i == 0 && j == N)) {
+                continue;
+            }
+            const int from = i % N, to = j % N;
+
+            if (instance.demands[from] + instance.demands[to] > instance.vehicleCapacity) {
+                continue;
+            }
+            long long earliestArrival = (long long)instance.timeWindows[from].first
+                                      + instance.serviceTimes[from] + instance.distanceMatrix[from][to];
+            if (earliestArrival > instance.timeWindows[to].second) {
+                continue;
+            }
+
+            arcSet.arcIndex[i][j] = (int)arcSet.arcs.size();
+            arcSet.outgoing[i].push_back((int)arcSet.arcs.size());
+            arcSet.incoming[j].push_back((int)arcSet.arcs.size());
+            arcSet.arcs.emplace_back(i, j);
+        }
+    }
+
+    return arcSet;
+}
+
+VrptwArcSet VrptwPreprocessing::granularArcs(const VrptwInstance& instance, const VrptwArcSet& feasible, int k,
+                                             const VrptwSolution& keep) {
+    const int N = instance.numberOfNodes;
+    std::vector<std::vector<char>> selected(N + 1, std::vector<char>(N + 1, 0));
+
+    auto score = [&](int i, int j) {
+        const int from = i % N, to = j % N;
+        long long latestArrival = (long long)instance.timeWindows[from].second
+                                + instance.serviceTimes[from] + instance.distanceMatrix[from][to];
+        return instance.distanceMatrix[from][to] + std::max(0LL, instance.timeWindows[to].first - latestArrival);
+    };
+    auto selectBest = [&](std::vector<std::pair<long long, int>>& candidates) {
+        int count = std::min(k, (int)candidates.size());
+        std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end());
+        candidates.resize(count);
+    };
+
+    for (int i = 1; i < N; ++i) {
+        std::vector<std::pair<long long, int>> successors, predecessors;
+        for (int a : feasible.outgoing[i]) {
+            const int j = feasible.arcs[a].second;
+            if (j == N) {selected[i][j] = 1;}
+            else {successors.emplace_back(score(i, j), a);}
+        }
+        for (int a : feasible.incoming[i]) {
+            const int h = feasible.arcs[a].first;
+            if (h == 0) {selected[h][i] = 1;}
+            else {predecessors.emplace_back(score(h, i), a);}
+        }
+        selectBest(successors);
+        selectBest(predecessors);
+        for (auto& candidate : successors) {
+            selected[feasible.arcs[candidate.second].first][feasible.arcs[candidate.second].second] = 1;
+        }
+        for (auto& candidate : predecessors) {
+            selected[feasible.arcs[candidate.second].first][feasible.arcs[candidate.second].second] = 1;
+        }
+    }
+    for (const VrptwRoute& route : keep.routes) {
+        for (int a : feasible.routeArcs(route.customers)) {
+            selected[feasible.arcs[a].first][feasible.arcs[a].second] = 1;
+        }
+    }
+
+    VrptwArcSet arcSet;
+    arcSet.outgoing.resize(N + 1);
+    arcSet.incoming.resize(N + 1);
+    arcSet.arcIndex.assign(N + 1, std::vector<int>(N + 1, -1));
+    for (const auto& arc : feasible.arcs) {
+        if (!selected[arc.first][arc.second]) {
+            continue;
+        }
+        arcSet.arcIndex[arc.first][arc.second] = (int)arcSet.arcs.size();
+        arcSet.outgoing[arc.first].push_back((int)arcSet.arcs.size());
+        arcSet.incoming[arc.second].push_back((int)arcSet.arcs.size());
+        arcSet.arcs.push_back(arc);
+    }
+
+    return arcSet;
+}
+
+int VrptwPreprocessing::timeBigM(const VrptwInstance& instance, int i, int j) {
+    const int N = instance.numberOfNodes;
+    const int from = i % N, to = j % N;
+
+    long long latestStart = (i == 0) ? instance.timeWindows[0].first : instance.timeWindows[from].second;
+    long long bigM = latestStart + instance.serviceTimes[from] + instance.distanceMatrix[from][to]
+                   - instance.timeWindows[to].first;
+    return (int)std::max(0LL, bigM);
+}
+
+int VrptwPreprocessing::loadBigM(const VrptwInstance& instance, int i, int j) {
+    if (i == 0) {
+        return 0;
+    }
+    return std::max(0, instance.vehicleCapacity - instance.demands[j % instance.numberOfNodes]);
+}
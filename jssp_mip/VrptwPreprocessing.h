@@ -0,0 +1,69 @@
+#pragma once
+
+#include "VrptwInstance.h"
+
+#include <algorithm>
+#include <vector>
+
+
+struct VrptwArcSet {
+    /// <summary>
+    /// Arcs of the two-index graph that can appear in a feasible route.
+    /// Nodes are 0 (start depot), 1..N-1 (customers) and N (end depot, copy of 0).
+    /// </summary>
+    std::vector<std::pair<int, int>> arcs;
+    std::vector<std::vector<int>> outgoing; // outgoing[i] = indices into arcs leaving i
+    std::vector<std::vector<int>> incoming; // incoming[j] = indices into arcs entering j
+    std::vector<std::vector<int>> arcIndex; // arcIndex[i][j] = index into arcs, -1 if eliminated
+
+    bool contains(int i, int j) const { return arcIndex[i][j] >= 0; }
+
+    // Arc indices of the route 0 -> customers -> N, empty if an arc was eliminated.
+    std::vector<int> routeArcs(const std::vector<int>& customers) const {
+        const int N = (int)arcIndex.size() - 1;
+        std::vector<int> route;
+        int previous = 0;
+        for (int customer : customers) {
+            route.push_back(arcIndex[previous][customer]);
+            previous = customer;
+        }
+        route.push_back(arcIndex[previous][N]);
+        if (std::find(route.begin(), route.end(), -1) != route.end()) {
+            route.clear();
+        }
+        return route;
+    }
+};
+
+
+/**
+ Reductions of a VRPTW instance applied before the MIP is built.
+ */
+class VrptwPreprocessing {
+public:
+    // Desrochers-style time window reduction, repeated until no window changes. For customer k, with P(k) / S(k) the nodes
+    // that can precede / follow it (the depot included):
+    //   a_k >= min(b_k, min_{i in P(k)} a_i + s_i + t_ik)    earliest arrival from the predecessors
+    //   a_k >= min(b_k, min_{j in S(k)} a_j - s_k - t_kj)    earliest departure to the successors
+    //   b_k <= max(a_k, max_{i in P(k)} b_i + s_i + t_ik)    latest arrival from the predecessors
+    //   b_k <= max(a_k, max_{j in S(k)} b_j - s_k - t_kj)    latest departure to the successors
+    // Every feasible route stays feasible. Returns the number of customers whose window changed,
+    // throws if a customer cannot be reached from the depot and back within its window.
+    static int tightenTimeWindows(VrptwInstance& instance);
+
+    // Arc (i, j) is kept iff a_i + s_i + t_ij <= b_j and d_i + d_j <= Q.
+    // Self-loops, arcs into the start depot, out of the end depot and the empty route 0 -> N are dropped.
+    static VrptwArcSet feasibleArcs(const VrptwInstance& instance);
+
+    // Subset of feasible keeping, per customer, the arcs to its k best successors and from its k best predecessors,
+    // scored by t_ij plus the waiting time at j even when leaving i at b_i. Depot arcs and the arcs of keep are always kept,
+    // so a warm start stays feasible in the restricted model.
+    static VrptwArcSet granularArcs(const VrptwInstance& instance, const VrptwArcSet& feasible, int k, const VrptwSolution& keep);
+
+    // Big-M of the row "w_j >= w_i + s_i + t_ij - M (1 - x_ij)": max(0, b_i + s_i + t_ij - a_j).
+    // The start depot leaves at a_0, so b_0 is taken as a_0.
+    static int timeBigM(const VrptwInstance& instance, int i, int j);
+
+    // Big-M of the row "y_j >= y_i + d_j x_ij - M (1 - x_ij)": Q - d_j, 0 out of the start depot (y_0 = 0).
+    static int loadBigM(const VrptwInstance& instance, int i, int j);
+};
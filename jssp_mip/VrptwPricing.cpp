@@ -0,0 +1,298 @@
+#pragma once
+
+#include "VrptwPricing.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <set>
+#include <utility>
+#include <vector>
+
+
+using std::vector;
+
+namespace {
+
+constexpr double reducedCostTolerance = 1e-6;
+
+struct JoinCandidate {
+    double reducedCost;
+    int forwardLabel;
+    int backwardLabel;
+};
+
+}
+
+
+VrptwPricing::VrptwPricing(const VrptwInstance& instance, const VrptwArcSet& arcSet, int ngSize)
+    : instance(instance), arcSet(arcSet), N(instance.numberOfNodes) {
+
+    ngSize = std::clamp(ngSize, 1, 64);
+
+    // ------ ng-neighbourhoods: the customer and its nearest customers. ---------------
+    ngNeighbours.assign(N + 1, vector<int>());
+    ngPosition.assign(N + 1, vector<int>(N + 1, -1));
+    vector<int> customers(N - 1);
+    std::iota(customers.begin(), customers.end(), 1);
+    for (int i = 1; i < N; ++i) {
+        vector<int> nearest = customers;
+        std::sort(nearest.begin(), nearest.end(), [&](int u, int v) {
+            return instance.distanceMatrix[i][u] < instance.distanceMatrix[i][v];
+        });
+        ngNeighbours[i].push_back(i);
+        for (int u : nearest) {
+            if ((int)ngNeighbours[i].size() >= ngSize) {break;}
+            if (u != i) {ngNeighbours[i].push_back(u);}
+        }
+        for (int p = 0; p < (int)ngNeighbours[i].size(); ++p) {
+            ngPosition[i][ngNeighbours[i][p]] = p;
+        }
+    }
+
+    // ------ Time horizon. ---------------
+    long long latestReturn = instance.timeWindows[0].first;
+    for (int i = 1; i < N; ++i) {
+        latestReturn = std::max(latestReturn, (long long)instance.timeWindows[i].second
+                                              + instance.serviceTimes[i] + instance.distanceMatrix[i][0]);
+    }
+    horizon = (int)std::min(latestReturn, (long long)instance.timeWindows[0].second);
+    middleTime = instance.timeWindows[0].first + (horizon - instance.timeWindows[0].first) / 2;
+}
+
+bool VrptwPricing::inMemory(const Label& label, int customer) const {
+    int p = ngPosition[label.node][customer];
+    return p >= 0 && ((label.memory >> p) & 1);
+}
+
+uint64_t VrptwPricing::extendMemory(const Label& label, int node) const {
+    uint64_t memory = 0;
+    for (int p = 0; p < (int)ngNeighbours[node].size(); ++p) {
+        int u = ngNeighbours[node][p];
+        if (u == node || inMemory(label, u)) {
+            memory |= uint64_t(1) << p;
+        }
+    }
+    return memory;
+}
+
+bool VrptwPricing::memoriesOverlap(const Label& forward, const Label& backward) const {
+    for (int p = 0; p < (int)ngNeighbours[forward.node].size(); ++p) {
+        if (((forward.memory >> p) & 1) && inMemory(backward, ngNeighbours[forward.node][p])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int VrptwPricing::insertLabel(vector<Label>& pool, vector<int>& labelsAtNode, const Label& label, bool forward) {
+    auto dominates = [forward](const Label& a, const Label& b) {
+        return a.cost <= b.cost + reducedCostTolerance
+            && a.load <= b.load
+            && (forward ? a.time <= b.time : a.time >= b.time)
+            && (a.memory & ~b.memory) == 0;
+    };
+
+    for (int idx : labelsAtNode) {
+        if (dominates(pool[idx], label)) {
+            return -1;
+        }
+    }
+    for (size_t k = 0; k < labelsAtNode.size();) {
+        Label& other = pool[labelsAtNode[k]];
+        if (dominates(label, other)) {
+            other.dominated = true;
+            labelsAtNode[k] = labelsAtNode.back();
+            labelsAtNode.pop_back();
+        }
+        else {
+            k++;
+        }
+    }
+
+    pool.push_back(label);
+    labelsAtNode.push_back((int)pool.size() - 1);
+    return (int)pool.size() - 1;
+}
+
+vector<vector<int>> VrptwPricing::labelForward(const vector<double>& arcCosts, const vector<char>& arcAllowed) {
+    vector<vector<int>> labelsAtNode(N + 1);
+    forwardLabels.clear();
+    forwardLabels.push_back({ 0, instance.timeWindows[0].first, 0, 0, 0, -1, false });
+    labelsAtNode[0].push_back(0);
+
+    // Earliest label first, extensions never decrease the time.
+    using QueueEntry = std::pair<int, int>;
+    std::priority_queue<QueueEntry, vector<QueueEntry>, std::greater<QueueEntry>> queue;
+    queue.push({ forwardLabels[0].time, 0 });
+
+    while (!queue.empty()) {
+        int idx = queue.top().second;
+        queue.pop();
+        if (forwardLabels[idx].dominated) {
+            continue;
+        }
+        const Label label = forwardLabels[idx];
+        const int v = label.node;
+        if (v != 0 && label.time > middleTime) {
+            continue;
+        }
+
+        for (int a : arcSet.outgoing[v]) {
+            const int j = arcSet.arcs[a].second;
+            if (!arcAllowed[a] || j == N || inMemory(label, j)) {
+                continue;
+            }
+            int load = label.load + instance.demands[j];
+            int time = std::max(instance.timeWindows[j].first,
+                                label.time + instance.serviceTimes[v] + instance.distanceMatrix[v][j]);
+            if (load > instance.vehicleCapacity || time > instance.timeWindows[j].second) {
+                continue;
+            }
+
+            Label extended{ label.cost + arcCosts[a], time, load, extendMemory(label, j), j, idx, false };
+            int newIdx = insertLabel(forwardLabels, labelsAtNode[j], extended, true);
+            if (newIdx >= 0) {
+                queue.push({ time, newIdx });
+            }
+        }
+    }
+    return labelsAtNode;
+}
+
+vector<vector<int>> VrptwPricing::labelBackward(const vector<double>& arcCosts, const vector<char>& arcAllowed) {
+    vector<vector<int>> labelsAtNode(N + 1);
+    backwardLabels.clear();
+    backwardLabels.push_back({ 0, horizon, 0, 0, N, -1, false });
+    labelsAtNode[N].push_back(0);
+
+    // Latest label first, backward extensions never increase the time.
+    std::priority_queue<std::pair<int, int>> queue;
+    queue.push({ horizon, 0 });
+
+    while (!queue.empty()) {
+        int idx = queue.top().second;
+        queue.pop();
+        if (backwardLabels[idx].dominated) {
+            continue;
+        }
+        const Label label = backwardLabels[idx];
+        const int v = label.node;
+        if (v != N && label.time < middleTime) {
+            continue;
+        }
+
+        for (int a : arcSet.incoming[v]) {
+            const int i = arcSet.arcs[a].first;
+            if (!arcAllowed[a] || i == 0 || inMemory(label, i)) {
+                continue;
+            }
+            int load = label.load + instance.demands[i];
+            int time = std::min(instance.timeWindows[i].second,
+                                label.time - instance.serviceTimes[i] - instance.distanceMatrix[i][v % N]);
+            if (load > instance.vehicleCapacity || time < instance.timeWindows[i].first) {
+                continue;
+            }
+
+            Label extended{ label.cost + arcCosts[a], time, load, extendMemory(label, i), i, idx, false };
+            int newIdx = insertLabel(backwardLabels, labelsAtNode[i], extended, false);
+            if (newIdx >= 0) {
+                queue.push({ time, newIdx });
+            }
+        }
+    }
+    return labelsAtNode;
+}
+
+VrptwRoute VrptwPricing::buildRoute(int forwardLabel, int backwardLabel) const {
+    VrptwRoute route;
+    for (int idx = forwardLabel; idx >= 0 && forwardLabels[idx].node != 0; idx = forwardLabels[idx].parent) {
+        route.customers.push_back(forwardLabels[idx].node);
+    }
+    std::reverse(route.customers.begin(), route.customers.end());
+    for (int idx = backwardLabel; idx >= 0 && backwardLabels[idx].node != N; idx = backwardLabels[idx].parent) {
+        route.customers.push_back(backwardLabels[idx].node);
+    }
+
+    int previous = 0;
+    for (int customer : route.customers) {
+        route.cost += instance.distanceMatrix[previous][customer];
+        previous = customer;
+    }
+    route.cost += instance.distanceMatrix[previous][0];
+    return route;
+}
+
+vector<VrptwRoute> VrptwPricing::negativeRoutes(const vector<double>& customerDuals, double fleetDual,
+                                                const vector<char>& arcAllowed, int maxRoutes,
+                                                double& minReducedCost) {
+    const int numberOfArcs = (int)arcSet.arcs.size();
+
+    // Reduced arc costs, the dual of a customer is collected on the arcs entering it.
+    vector<double> arcCosts(numberOfArcs);
+    for (int a = 0; a < numberOfArcs; ++a) {
+        auto [i, j] = arcSet.arcs[a];
+        arcCosts[a] = instance.distanceMatrix[i % N][j % N];
+        if (j != N) {arcCosts[a] -= customerDuals[j];}
+        if (i == 0) {arcCosts[a] -= fleetDual;}
+    }
+
+    vector<vector<int>> forwardAtNode = labelForward(arcCosts, arcAllowed);
+    vector<vector<int>> backwardAtNode = labelBackward(arcCosts, arcAllowed);
+    for (vector<int>& labels : backwardAtNode) {
+        std::sort(labels.begin(), labels.end(), [&](int a, int b) { return backwardLabels[a].cost < backwardLabels[b].cost; });
+    }
+
+    // ------ Join forward and backward labels over every arc. ---------------
+    vector<JoinCandidate> candidates;
+    const size_t candidateLimit = (size_t)std::max(1, maxRoutes) * 20;
+    auto byReducedCost = [](const JoinCandidate& a, const JoinCandidate& b) { return a.reducedCost < b.reducedCost; };
+
+    for (int a = 0; a < numberOfArcs; ++a) {
+        if (!arcAllowed[a]) {
+            continue;
+        }
+        auto [i, j] = arcSet.arcs[a];
+        const int departure = instance.serviceTimes[i % N] + instance.distanceMatrix[i % N][j % N];
+
+        for (int f : forwardAtNode[i]) {
+            const Label& forward = forwardLabels[f];
+            for (int b : backwardAtNode[j]) {
+                const Label& backward = backwardLabels[b];
+                double reducedCost = forward.cost + arcCosts[a] + backward.cost;
+                if (reducedCost >= -reducedCostTolerance) {
+                    break;
+                }
+                if (forward.time + departure > backward.time
+                    || forward.load + backward.load > instance.vehicleCapacity
+                    || memoriesOverlap(forward, backward)) {
+                    continue;
+                }
+                candidates.push_back({ reducedCost, f, b });
+            }
+        }
+
+        if (candidates.size() > 2 * candidateLimit) {
+            std::nth_element(candidates.begin(), candidates.begin() + candidateLimit, candidates.end(), byReducedCost);
+            candidates.resize(candidateLimit);
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(), byReducedCost);
+    minReducedCost = candidates.empty() ? 0 : candidates.front().reducedCost;
+
+    // The same route can be joined over several of its arcs.
+    vector<VrptwRoute> routes;
+    std::set<vector<int>> seen;
+    for (const JoinCandidate& candidate : candidates) {
+        if ((int)routes.size() >= maxRoutes) {
+            break;
+        }
+        VrptwRoute route = buildRoute(candidate.forwardLabel, candidate.backwardLabel);
+        if (seen.insert(route.customers).second) {
+            routes.push_back(std::move(route));
+        }
+    }
+    return routes;
+}
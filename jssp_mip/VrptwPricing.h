@@ -0,0 +1,64 @@
+#pragma once
+
+#include "VrptwInstance.h"
+#include "VrptwPreprocessing.h"
+
+#include <cstdint>
+#include <vector>
+
+
+/**
+ Pricing problem of the VRPTW set-partitioning master: elementary shortest path with resource constraints,
+ relaxed to ng-routes (Baldacci et al.). A customer may be revisited unless it is in the ng-memory of the label,
+ the memory of a label at node v is a subset of the ngSize nearest customers of v.
+ Labels are extended forward from the start depot and backward from the end depot up to the middle
+ of the time horizon and joined over the arcs (Righini and Salani).
+ */
+class VrptwPricing {
+    struct Label {
+        double cost;      // reduced cost of the partial path
+        int time;         // forward: earliest service start at node, backward: latest service start
+        int load;
+        uint64_t memory;  // bit p set iff ngNeighbours[node][p] is in the ng-memory
+        int node;
+        int parent;       // index in the label pool, -1 at a depot
+        bool dominated;
+    };
+
+    const VrptwInstance& instance;
+    const VrptwArcSet& arcSet;
+    const int N;
+
+    int horizon;      // latest return to the depot
+    int middleTime;   // forward labels are extended up to it, backward labels down to it
+
+    std::vector<std::vector<int>> ngNeighbours; // ngNeighbours[i] = i followed by its ngSize - 1 nearest customers
+    std::vector<std::vector<int>> ngPosition;   // ngPosition[i][u] = position of u in ngNeighbours[i], -1 if absent
+
+    std::vector<Label> forwardLabels;
+    std::vector<Label> backwardLabels;
+
+    bool inMemory(const Label& label, int customer) const;
+    uint64_t extendMemory(const Label& label, int node) const;
+    bool memoriesOverlap(const Label& forward, const Label& backward) const;
+
+    // Adds label to the pool unless a label at its node dominates it, drops the labels it dominates.
+    // Returns the pool index, -1 if dominated.
+    int insertLabel(std::vector<Label>& pool, std::vector<int>& labelsAtNode, const Label& label, bool forward);
+
+    // Label-setting in order of time, forward or backward. Returns labels per node.
+    std::vector<std::vector<int>> labelForward(const std::vector<double>& arcCosts, const std::vector<char>& arcAllowed);
+    std::vector<std::vector<int>> labelBackward(const std::vector<double>& arcCosts, const std::vector<char>& arcAllowed);
+
+    VrptwRoute buildRoute(int forwardLabel, int backwardLabel) const;
+
+public:
+    VrptwPricing(const VrptwInstance& instance, const VrptwArcSet& arcSet, int ngSize = 8);
+
+    // Routes with reduced cost below -tolerance, most negative first, at most maxRoutes.
+    // customerDuals[i] belongs to the cover row of customer i, fleetDual to the vehicle count row,
+    // arcAllowed[a] == 0 excludes arc a (branching). minReducedCost returns the most negative reduced cost found.
+    std::vector<VrptwRoute> negativeRoutes(const std::vector<double>& customerDuals, double fleetDual,
+                                           const std::vector<char>& arcAllowed, int maxRoutes,
+                                           double& minReducedCost);
+};
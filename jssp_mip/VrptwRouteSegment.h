@@ -0,0 +1,56 @@
+#pragma once
+
+#include "VrptwInstance.h"
+
+#include <algorithm>
+
+
+struct VrptwRouteSegment {
+    /// <summary>
+    /// Summary of a node sequence for O(1) concatenation (Vidal et al., 2013).
+    /// Times are service starts, the duration includes the service of every node; time warp is the total
+    /// lateness that would be needed to meet every window, so the sequence is time feasible iff timeWarp == 0.
+    /// </summary>
+    int first = 0;
+    int last = 0;
+    long long duration = 0;
+    long long timeWarp = 0;
+    long long earliestStart = 0; // earliest service start at first with minimal duration and time warp
+    long long latestStart = 0;   // latest service start at first without adding time warp
+    int load = 0;
+    int distance = 0;
+
+    // Segment of the single node i.
+    static VrptwRouteSegment node(const VrptwInstance& instance, int i) {
+        VrptwRouteSegment segment;
+        segment.first = segment.last = i;
+        segment.duration = instance.serviceTimes[i];
+        segment.earliestStart = instance.timeWindows[i].first;
+        segment.latestStart = instance.timeWindows[i].second;
+        segment.load = instance.demands[i];
+        return segment;
+    }
+
+    // The sequence a followed by b.
+    static VrptwRouteSegment concatenate(const VrptwInstance& instance, const VrptwRouteSegment& a, const VrptwRouteSegment& b) {
+        const int travel = instance.distanceMatrix[a.last][b.first];
+        const long long delta = a.duration - a.timeWarp + travel;
+        const long long waiting = std::max(b.earliestStart - delta - a.latestStart, 0LL);
+        const long long warp = std::max(a.earliestStart + delta - b.latestStart, 0LL);
+
+        VrptwRouteSegment segment;
+        segment.first = a.first;
+        segment.last = b.last;
+        segment.duration = a.duration + b.duration + travel + waiting;
+        segment.timeWarp = a.timeWarp + b.timeWarp + warp;
+        segment.earliestStart = std::max(b.earliestStart - delta, a.earliestStart) - waiting;
+        segment.latestStart = std::min(b.latestStart - delta, a.latestStart) + warp;
+        segment.load = a.load + b.load;
+        segment.distance = a.distance + b.distance + travel;
+        return segment;
+    }
+
+    bool feasible(const VrptwInstance& instance) const {
+        return timeWarp == 0 && load <= instance.vehicleCapacity;
+    }
+};
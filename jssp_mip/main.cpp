@@ -4,11 +4,110 @@
 #include "VrptwMIP.h"
 #include "CspMIP.h"
 #include "GrMIP.h"
+#include "BatchRunner.h"
+#include "LoaderJSPLIB.h"
+#include "InstanceCache.h"
 
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
 
-int main() {
+
+// --batch <jsp|vrptw|csp|gr> <directory|list file> [workers] [total threads] [results.csv]
+static int runBatch(int argc, char* argv[], float timeLimit) {
+	if (argc < 4) {
+		std::cerr << "Usage: " << argv[0] << " --batch <jsp|vrptw|csp|gr> <directory|list file> [workers] [total threads] [results.csv]" << std::endl;
+		return 1;
+	}
+	std::string problem = argv[2];
+	std::string path = argv[3];
+	int workers = argc > 4 ? std::atoi(argv[4]) : 1;
+	int totalThreads = argc > 5 ? std::atoi(argv[5]) : 0;
+	std::string resultsPath = argc > 6 ? argv[6] : "results.csv";
+
+	BatchRunner::ModelFactory factory;
+	std::vector<std::string> instancePaths;
+	if (problem == "jsp") {
+		factory = [] { return std::make_unique<JspMIP>(); };
+		// Multi-instance JSPLIB files expand to one "path#name" entry per instance.
+		for (const std::string& file : BatchRunner::listInstances(path, ".txt")) {
+			for (std::string& spec : LoaderJSPLIB::listInstanceSpecs(file)) {
+				instancePaths.push_back(std::move(spec));
+			}
+		}
+	}
+	else if (problem == "vrptw") {
+		factory = [] { return std::make_unique<VrptwMIP>(); };
+		instancePaths = BatchRunner::listInstances(path, std::vector<std::string>{ ".xml", ".txt" }); // VRP-REP or Solomon / Gehring-Homberger
+	}
+	else if (problem == "csp") {
+		factory = [] { return std::make_unique<CspMIP>(); };
+		instancePaths = BatchRunner::listInstances(path, ".txt");
+	}
+	else if (problem == "gr") {
+		factory = [] { return std::make_unique<GrMIP>(); };
+		instancePaths = BatchRunner::listInstances(path, ".txt");
+	}
+	else {
+		std::cerr << "Unknown problem type: " << problem << std::endl;
+		return 1;
+	}
+
+	BatchRunner runner(factory, workers, totalThreads, timeLimit);
+	runner.run(instancePaths, resultsPath);
+	return 0;
+}
+
+// --convert <jsp|vrptw|csp> <directory|list file>: writes the binary cache next to every instance.
+static int convertInstances(int argc, char* argv[]) {
+	if (argc < 4) {
+		std::cerr << "Usage: " << argv[0] << " --convert <jsp|vrptw|csp> <directory|list file>" << std::endl;
+		return 1;
+	}
+	std::string problem = argv[2];
+	std::string path = argv[3];
+
+	std::vector<std::string> instanceSpecs;
+	std::vector<std::string> extensions = { ".txt" };
+	if (problem == "vrptw") {
+		extensions.push_back(".xml");
+	}
+	for (const std::string& file : BatchRunner::listInstances(path, extensions)) {
+		if (problem == "jsp") {
+			for (std::string& spec : LoaderJSPLIB::listInstanceSpecs(file)) {
+				instanceSpecs.push_back(std::move(spec));
+			}
+		}
+		else {
+			instanceSpecs.push_back(file);
+		}
+	}
+
+	int failed = 0;
+	for (const std::string& spec : instanceSpecs) {
+		try {
+			std::cout << spec << " -> " << InstanceCache::convert(problem, spec) << std::endl;
+		}
+		catch (const std::exception& error) {
+			std::cerr << spec << ": " << error.what() << std::endl;
+			failed++;
+		}
+	}
+	return failed == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
 	float timeLimit = 3000.0;
 
+	if (argc > 1 && std::strcmp(argv[1], "--batch") == 0) {
+		return runBatch(argc, argv, timeLimit);
+	}
+	if (argc > 1 && std::strcmp(argv[1], "--convert") == 0) {
+		return convertInstances(argc, argv);
+	}
+
 	//JspMIP model1;
 	//model1.solveInstance("datasets/JSPLIB/abz5.txt", timeLimit);
 
@@ -23,4 +122,4 @@ int main() {
 
 
 	return 0;
-}
\ No newline at end of file
+}